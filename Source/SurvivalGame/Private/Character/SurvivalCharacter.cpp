@@ -5,7 +5,9 @@
 #include "GameFramework/PlayerState.h"
 #include "GameFramework/DamageType.h"
 #include "Materials/MaterialInstance.h"
+#include "Engine/SkeletalMesh.h"
 #include "Kismet/GameplayStatics.h"
+#include "EngineUtils.h"
 
 #include "Net/UnrealNetwork.h"
 
@@ -17,20 +19,124 @@
 #include "Components/InteractionComponent.h"
 #include "Components/InventoryComponent.h"
 #include "World/Pickup.h"
+#include "World/SurvivalCorpse.h"
 #include "Items/GearItem.h"
 #include "Items/WeaponItem.h"
 #include "Items/ThrowableItem.h"
 #include "Character/SurvivalPlayerController.h"
+#include "GameFramework/SurvivalGameInstance.h"
+#include "GameFramework/SurvivalGameStateBase.h"
+#include "GameFramework/SurvivalNetAccounting.h"
+#include "Components/RagdollBudgetComponent.h"
 #include "Weapons/MeleeDamage.h"
 #include "Weapons/WeaponActor.h"
 #include "Animation/AnimMontage.h"
+#include "SignificanceManager.h"
 
 #define LOCTEXT_NAMESPACE "Player"
 #define NAME_ADS_Socket FName("ADSSocket")
 
+#define NAME_Significance_Character FName("SurvivalCharacter")
+
+// Significance tiers, 0 is far away and hidden, 3 is close, visible or firing
+static const int32 MaxSignificanceTier = 3;
+static const float SignificanceTierDistances[] = { 8000.f, 4000.f, 1500.f };
+static const float SignificanceTierTickIntervals[] = { 0.25f, 0.1f, 0.033f, 0.f };
+
+static_assert(NumEquippableSlots <= 16, "EquippedSlotMask holds one bit per equipment slot");
+
+DECLARE_CYCLE_STAT(TEXT("Character Camera Tick"), STAT_CharacterCameraTick, STATGROUP_SurvivalGame);
+DECLARE_CYCLE_STAT(TEXT("Character Interaction Tick"), STAT_CharacterInteractionTick, STATGROUP_SurvivalGame);
+DECLARE_CYCLE_STAT(TEXT("Perform Interaction Check"), STAT_PerformInteractionCheck, STATGROUP_SurvivalGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Characters With Merged Gear"), STAT_CharactersWithMergedGear, STATGROUP_SurvivalGame);
+DECLARE_CYCLE_STAT(TEXT("Melee Swing Sweep"), STAT_MeleeSwingSweep, STATGROUP_SurvivalGame);
+DECLARE_CYCLE_STAT(TEXT("Melee Hit Validation"), STAT_MeleeHitValidation, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Melee Sweeps"), STAT_MeleeSweeps, STATGROUP_SurvivalGame);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Last Melee Swing Cost (ms)"), STAT_MeleeSwingCost, STATGROUP_SurvivalGame);
+
+bool FEquipmentAppearance::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess) {
+
+	uint32 SlotMask = 0;
+
+	if (Ar.IsSaving()) {
+
+		for (int32 SlotIndex = 0; SlotIndex < NumEquippableSlots; ++SlotIndex) {
+
+			if (Gear[SlotIndex] != nullptr) {
+
+				SlotMask |= (1 << SlotIndex);
+			}
+		}
+	}
+
+	Ar.SerializeBits(&SlotMask, NumEquippableSlots);
+
+	if (Ar.IsLoading()) {
+
+		Gear.SetNumZeroed(NumEquippableSlots);
+	}
+
+	bOutSuccess = true;
+
+	for (int32 SlotIndex = 0; SlotIndex < NumEquippableSlots; ++SlotIndex) {
+
+		if (SlotMask & (1 << SlotIndex)) {
+
+			UObject* GearClass = *Gear[SlotIndex];
+			bOutSuccess &= Map->SerializeObject(Ar, UClass::StaticClass(), GearClass);
+
+			if (Ar.IsLoading()) {
+
+				UClass* LoadedClass = Cast<UClass>(GearClass);
+				Gear[SlotIndex] = (LoadedClass && LoadedClass->IsChildOf(UGearItem::StaticClass())) ? LoadedClass : nullptr;
+			}
+		}
+		else if (Ar.IsLoading()) {
+
+			Gear[SlotIndex] = nullptr;
+		}
+	}
+
+	return true;
+}
+
+void FSurvivalCharacterTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) {
+
+	if (Target && !Target->IsPendingKillOrUnreachable() && TickMethod && TickType != LEVELTICK_ViewportsOnly) {
+
+		(Target->*TickMethod)(DeltaTime);
+	}
+}
+
+FString FSurvivalCharacterTickFunction::DiagnosticMessage() {
+
+	return Target ? Target->GetFullName() + TEXT("[SurvivalCharacterTick]") : TEXT("<NULL>[SurvivalCharacterTick]");
+}
+
 ASurvivalCharacter::ASurvivalCharacter()
 {
-	PrimaryActorTick.bCanEverTick = true;
+	// All per frame work lives in the tick functions below, a Blueprint implementing Event Tick gets the actor tick back when compiled
+	PrimaryActorTick.bCanEverTick = false;
+
+	// All three start disabled, they are switched on once we know who controls this character
+	CameraTickFunction.bCanEverTick = true;
+	CameraTickFunction.bStartWithTickEnabled = false;
+	CameraTickFunction.TickGroup = TG_PrePhysics;
+	CameraTickFunction.Target = this;
+	CameraTickFunction.TickMethod = &ASurvivalCharacter::TickCamera;
+
+	InteractionTickFunction.bCanEverTick = true;
+	InteractionTickFunction.bStartWithTickEnabled = false;
+	InteractionTickFunction.TickGroup = TG_PrePhysics;
+	InteractionTickFunction.Target = this;
+	InteractionTickFunction.TickMethod = &ASurvivalCharacter::TickInteraction;
+
+	// After animation so the melee socket is where the pose put it this frame
+	MeleeTickFunction.bCanEverTick = true;
+	MeleeTickFunction.bStartWithTickEnabled = false;
+	MeleeTickFunction.TickGroup = TG_PostUpdateWork;
+	MeleeTickFunction.Target = this;
+	MeleeTickFunction.TickMethod = &ASurvivalCharacter::TickMeleeSwing;
 
 	InventoryComponent = CreateDefaultSubobject<UInventoryComponent>(FName("Inventory Component"));
 	InventoryComponent->SetCapacity(20);
@@ -78,18 +184,33 @@ ASurvivalCharacter::ASurvivalCharacter()
 	BackpackMesh->SetupAttachment(GetMesh());
 	BackpackMesh->SetMasterPoseComponent(GetMesh());
 
-	PlayerMeshes.Add(EEquippableSlot::EES_Head, GetMesh());
-	PlayerMeshes.Add(EEquippableSlot::EES_Helmet, HelmetMesh);
-	PlayerMeshes.Add(EEquippableSlot::EES_Torso, TorsoMesh);
-	PlayerMeshes.Add(EEquippableSlot::EES_Legs, LegsMesh);
-	PlayerMeshes.Add(EEquippableSlot::EES_Feet, FeetMesh);
-	PlayerMeshes.Add(EEquippableSlot::EES_Hands, HandsMesh);
-	PlayerMeshes.Add(EEquippableSlot::EES_Vest, VestMesh);
-	PlayerMeshes.Add(EEquippableSlot::EES_Backpack, BackpackMesh);
+	// Hidden until the gear gets merged, follows the body animation like the other gear meshes
+	MergedGearMesh = CreateDefaultSubobject<USkeletalMeshComponent>(FName("MergedGearMeshComp"));
+	MergedGearMesh->SetupAttachment(GetMesh());
+	MergedGearMesh->SetMasterPoseComponent(GetMesh());
+	MergedGearMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	MergedGearMesh->bUseBoundsFromMasterPoseComponent = true;
+	MergedGearMesh->SetVisibility(false);
+
+	SlotMeshes.SetNumZeroed(NumEquippableSlots);
+	NakedMeshes.SetNumZeroed(NumEquippableSlots);
+	EquippedItems.SetNumZeroed(NumEquippableSlots);
+	EquippedSlotMask = 0;
+
+	SlotMeshes[static_cast<int32>(EEquippableSlot::EES_Head)] = GetMesh();
+	SlotMeshes[static_cast<int32>(EEquippableSlot::EES_Helmet)] = HelmetMesh;
+	SlotMeshes[static_cast<int32>(EEquippableSlot::EES_Torso)] = TorsoMesh;
+	SlotMeshes[static_cast<int32>(EEquippableSlot::EES_Legs)] = LegsMesh;
+	SlotMeshes[static_cast<int32>(EEquippableSlot::EES_Feet)] = FeetMesh;
+	SlotMeshes[static_cast<int32>(EEquippableSlot::EES_Hands)] = HandsMesh;
+	SlotMeshes[static_cast<int32>(EEquippableSlot::EES_Vest)] = VestMesh;
+	SlotMeshes[static_cast<int32>(EEquippableSlot::EES_Backpack)] = BackpackMesh;
+
+	for (int32 SlotIndex = 0; SlotIndex < NumEquippableSlots; ++SlotIndex) {
 
-	for (auto& PlayerMesh : PlayerMeshes) {
+		if (USkeletalMeshComponent* ThisMesh = SlotMeshes[SlotIndex]) {
 
-		if (USkeletalMeshComponent* ThisMesh = Cast<USkeletalMeshComponent>(PlayerMesh.Value)) {
+			PlayerMeshes.Add(static_cast<EEquippableSlot>(SlotIndex), ThisMesh);
 
 			ThisMesh->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
 			ThisMesh->SetCollisionObjectType(ECC_Pawn);
@@ -119,10 +240,19 @@ ASurvivalCharacter::ASurvivalCharacter()
 	MaxHealth = 100.f;
 	Health = MaxHealth;
 	DeadBodyLifespan = 120.f;
+	bDamageResolvePending = false;
+	CorpseClass = ASurvivalCorpse::StaticClass();
+	CorpseConversionDelay = 3.f;
 
 	LastMeleeAttackTime = 0.f;
 	MeleeAttackDistance = 150.f;
 	MeleeAttackDamage = 33.f;
+	MeleeSocketName = FName("hand_r");
+	MeleeHitRadius = 15.f;
+	MeleeActiveStart = 0.1f;
+	MeleeActiveEnd = 0.4f;
+	MeleeHitTolerance = 30.f;
+	MeleeSwingCycles = 0;
 	bIsAiming = false;
 
 	AimingFOV = 70.f;
@@ -130,6 +260,24 @@ ASurvivalCharacter::ASurvivalCharacter()
 
 	WalkSpeed = GetCharacterMovement()->MaxWalkSpeed;
 	MaxSprintSpeed = WalkSpeed * 1.3f;
+
+	bMergeGearMeshes = false;
+	bGearMeshesMerged = false;
+	bGearMeshMergePending = false;
+
+	SignificanceTickInterval = 0.f;
+	DefaultAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+}
+
+void ASurvivalCharacter::PostInitializeComponents() {
+
+	Super::PostInitializeComponents();
+
+	// Before any replicated appearance gets applied, which can happen ahead of BeginPlay
+	for (int32 SlotIndex = 0; SlotIndex < NumEquippableSlots; ++SlotIndex) {
+
+		NakedMeshes[SlotIndex] = SlotMeshes[SlotIndex] ? SlotMeshes[SlotIndex]->SkeletalMesh : nullptr;
+	}
 }
 
 void ASurvivalCharacter::BeginPlay()
@@ -143,23 +291,118 @@ void ASurvivalCharacter::BeginPlay()
 		DeadBodyInteractionComponent->SetInteractionNameText(FText::FromString(PS->GetPlayerName()));
 	}
 
-	for (auto& PlayerMesh : PlayerMeshes) {
+	DefaultAnimTickOption = GetMesh()->VisibilityBasedAnimTickOption;
+
+	if (bMergeGearMeshes && GetNetMode() != NM_DedicatedServer) {
 
-		NakedMeshes.Add(PlayerMesh.Key, PlayerMesh.Value->SkeletalMesh);
+		OnEquippmentChanged.AddDynamic(this, &ASurvivalCharacter::OnGearChanged);
+		RequestGearMeshMerge();
+	}
+
+	// Only viewers care how significant a character is
+	if (GetNetMode() != NM_DedicatedServer) {
+
+		if (USignificanceManager* SignificanceManager = FSignificanceManagerModule::Get(GetWorld())) {
+
+			auto SignificanceFunction = [](USignificanceManager::FManagedObjectInfo* ObjectInfo, const FTransform& Viewpoint) -> float {
+
+				const ASurvivalCharacter* Character = CastChecked<ASurvivalCharacter>(ObjectInfo->GetObject());
+				return Character->CalculateSignificance(Viewpoint);
+			};
+
+			auto PostSignificanceFunction = [](USignificanceManager::FManagedObjectInfo* ObjectInfo, float OldSignificance, float NewSignificance, bool bFinal) {
+
+				if (OldSignificance != NewSignificance) {
+
+					ASurvivalCharacter* Character = CastChecked<ASurvivalCharacter>(ObjectInfo->GetObject());
+					Character->OnSignificanceChanged(OldSignificance, NewSignificance);
+				}
+			};
+
+			SignificanceManager->RegisterObject(this, NAME_Significance_Character, SignificanceFunction, USignificanceManager::EPostSignificanceType::Sequential, PostSignificanceFunction);
+		}
 	}
 }
 
-void ASurvivalCharacter::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
+void ASurvivalCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason) {
 
-	const bool bIsInteractingOnServer = (HasAuthority() && GetIsInteracting());
+	if (GetNetMode() != NM_DedicatedServer) {
 
-	// Perform frequented check on Client only and only in InteractionCheckFrequency
-	if ((!HasAuthority() || bIsInteractingOnServer || IsLocallyControlled()) && GetWorld()->TimeSince(InteractData.LastInteractionTimeCheck > InteractionCheckFrequency)) {
+		if (USignificanceManager* SignificanceManager = FSignificanceManagerModule::Get(GetWorld())) {
 
-		PerformInteractionCheck();
+			SignificanceManager->UnregisterObject(this);
+		}
+	}
+
+	ClearMergedGearMesh();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ASurvivalCharacter::Destroyed() {
+
+	Super::Destroyed();
+
+	// Cached weapons are owned by this player only
+	if (HasAuthority()) {
+
+		for (auto& CachedWeapon : WeaponCache) {
+
+			if (CachedWeapon.Value != nullptr) {
+
+				CachedWeapon.Value->Destroy();
+			}
+		}
+
+		WeaponCache.Empty();
+	}
+}
+
+void ASurvivalCharacter::RegisterActorTickFunctions(bool bRegister) {
+
+	Super::RegisterActorTickFunctions(bRegister);
+
+	if (bRegister) {
+
+		// Nobody looks through the camera of a dedicated server
+		if (GetNetMode() != NM_DedicatedServer) {
+
+			CameraTickFunction.RegisterTickFunction(GetLevel());
+			MeleeTickFunction.RegisterTickFunction(GetLevel());
+		}
+
+		InteractionTickFunction.TickInterval = InteractionCheckFrequency;
+		InteractionTickFunction.RegisterTickFunction(GetLevel());
 	}
+	else {
+
+		if (CameraTickFunction.IsTickFunctionRegistered()) {
+
+			CameraTickFunction.UnRegisterTickFunction();
+		}
+
+		if (InteractionTickFunction.IsTickFunctionRegistered()) {
+
+			InteractionTickFunction.UnRegisterTickFunction();
+		}
+
+		if (MeleeTickFunction.IsTickFunctionRegistered()) {
+
+			MeleeTickFunction.UnRegisterTickFunction();
+		}
+	}
+}
+
+void ASurvivalCharacter::TickInteraction(float DeltaTime) {
+
+	SCOPE_CYCLE_COUNTER(STAT_CharacterInteractionTick);
+
+	PerformInteractionCheck();
+}
+
+void ASurvivalCharacter::TickCamera(float DeltaTime) {
+
+	SCOPE_CYCLE_COUNTER(STAT_CharacterCameraTick);
 
 	if (IsLocallyControlled()) {
 
@@ -179,16 +422,103 @@ void ASurvivalCharacter::Tick(float DeltaTime)
 	}
 }
 
+float ASurvivalCharacter::CalculateSignificance(const FTransform& Viewpoint) const {
+
+	if (IsLocallyControlled()) {
+
+		return MaxSignificanceTier;
+	}
+
+	const float DistanceSquared = FVector::DistSquared(Viewpoint.GetLocation(), GetActorLocation());
+
+	int32 Tier = 0;
+	while (Tier < MaxSignificanceTier && DistanceSquared < FMath::Square(SignificanceTierDistances[Tier])) {
+
+		++Tier;
+	}
+
+	// Off-screen characters drop a tier, players shooting at us never fall below the second highest one
+	if (!WasRecentlyRendered(0.2f)) {
+
+		Tier = FMath::Max(0, Tier - 1);
+	}
+
+	if (EquippedWeapon != nullptr && EquippedWeapon->BurstCounter > 0) {
+
+		Tier = FMath::Max(Tier, MaxSignificanceTier - 1);
+	}
+
+	return Tier;
+}
+
+void ASurvivalCharacter::OnSignificanceChanged(const float OldSignificance, const float NewSignificance) {
+
+	const int32 Tier = FMath::Clamp(FMath::RoundToInt(NewSignificance), 0, MaxSignificanceTier);
+
+	SignificanceTickInterval = SignificanceTierTickIntervals[Tier];
+
+	SetActorTickInterval(SignificanceTickInterval);
+
+	// Body mesh drives the animation of all gear meshes through the master pose
+	for (USkeletalMeshComponent* SlotMesh : SlotMeshes) {
+
+		if (SlotMesh != nullptr) {
+
+			SlotMesh->SetComponentTickInterval(SignificanceTickInterval);
+		}
+	}
+
+	MergedGearMesh->SetComponentTickInterval(SignificanceTickInterval);
+
+	// A merged character hides its body mesh, which then never counts as rendered and would freeze the merged pose
+	const bool bReducePoseTicks = (Tier == 0) && !bGearMeshesMerged;
+	GetMesh()->VisibilityBasedAnimTickOption = bReducePoseTicks ? EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered : DefaultAnimTickOption;
+
+	ApplySignificanceToWeapon();
+}
+
+void ASurvivalCharacter::ApplySignificanceToWeapon() {
+
+	if (EquippedWeapon != nullptr) {
+
+		EquippedWeapon->GetWeaponMesh()->SetComponentTickInterval(SignificanceTickInterval);
+	}
+}
+
 void ASurvivalCharacter::Restart() {
 
 	Super::Restart();
 
+	// Runs on the server and on the owning client, simulated proxies keep both ticks disabled
+	if (IsLocallyControlled()) {
+
+		CameraTickFunction.SetTickFunctionEnable(CameraTickFunction.IsTickFunctionRegistered());
+		InteractionTickFunction.SetTickFunctionEnable(true);
+
+		// First person view needs the separate meshes to hide the head only
+		ClearMergedGearMesh();
+	}
+
 	if (ASurvivalPlayerController* PlayerController = Cast<ASurvivalPlayerController>(GetController())) {
 
 		PlayerController->ShowIngameUI();
 	}
 }
 
+void ASurvivalCharacter::UnPossessed() {
+
+	Super::UnPossessed();
+
+	CameraTickFunction.SetTickFunctionEnable(false);
+	InteractionTickFunction.SetTickFunctionEnable(false);
+	EndMeleeSwing();
+
+	if (bMergeGearMeshes) {
+
+		RequestGearMeshMerge();
+	}
+}
+
 void ASurvivalCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const {
 
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
@@ -197,6 +527,9 @@ void ASurvivalCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& O
 	DOREPLIFETIME(ASurvivalCharacter, Killer);
 	DOREPLIFETIME(ASurvivalCharacter, EquippedWeapon);
 	DOREPLIFETIME(ASurvivalCharacter, bIsSprinting);
+	DOREPLIFETIME(ASurvivalCharacter, EquippedSlotMask);
+
+	DOREPLIFETIME_CONDITION(ASurvivalCharacter, EquipmentAppearance, COND_SkipOwner);
 
 	DOREPLIFETIME_CONDITION(ASurvivalCharacter, bIsAiming, COND_SkipOwner);
 
@@ -204,6 +537,20 @@ void ASurvivalCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& O
 	DOREPLIFETIME_CONDITION(ASurvivalCharacter, Health, COND_OwnerOnly);
 }
 
+bool ASurvivalCharacter::ReplicateSubobjects(class UActorChannel* Channel, class FOutBunch* Bunch, FReplicationFlags* RepFlags) {
+
+	FSurvivalNetAccounting::FScopedActorReplication ScopedAccounting(this, Channel, Bunch);
+
+	return Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
+}
+
+bool ASurvivalCharacter::CallRemoteFunction(UFunction* Function, void* Parameters, struct FOutParmRec* OutParms, FFrame* Stack) {
+
+	FSurvivalNetAccounting::FScopedRemoteFunction ScopedAccounting(this, Function);
+
+	return Super::CallRemoteFunction(Function, Parameters, OutParms, Stack);
+}
+
 void ASurvivalCharacter::SetActorHiddenInGame(bool bNewHidden) {
 
 	Super::SetActorHiddenInGame(bNewHidden);
@@ -218,6 +565,8 @@ void ASurvivalCharacter::SetActorHiddenInGame(bool bNewHidden) {
 
 void ASurvivalCharacter::PerformInteractionCheck() {
 
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_PerformInteractionCheck);
+
 	if (GetController() == nullptr) return;
 
 	InteractData.LastInteractionTimeCheck = GetWorld()->GetTimeSeconds();
@@ -303,6 +652,11 @@ void ASurvivalCharacter::Interact() {
 
 	GetWorldTimerManager().ClearTimer(TimerHandle_Interaction);
 
+	if (!IsLocallyControlled()) {
+
+		InteractionTickFunction.SetTickFunctionEnable(false);
+	}
+
 	if (UInteractionComponent* Interactable = GetInteractable()) {
 
 		Interactable->Interact(this);
@@ -330,6 +684,12 @@ void ASurvivalCharacter::BeginInteract() {
 
 		Interactable->BeginInteract(this);
 
+		// Server keeps checking the player still looks at the interactable for as long as the interaction lasts
+		if (HasAuthority()) {
+
+			InteractionTickFunction.SetTickFunctionEnable(true);
+		}
+
 		// check interaction duration
 		if (FMath::IsNearlyZero(Interactable->GetInteractionTime())) {
 
@@ -353,6 +713,11 @@ void ASurvivalCharacter::StopInteract() {
 
 	GetWorldTimerManager().ClearTimer(TimerHandle_Interaction);
 
+	if (!IsLocallyControlled()) {
+
+		InteractionTickFunction.SetTickFunctionEnable(false);
+	}
+
 	if (UInteractionComponent* Interactable = GetInteractable()) {
 
 		Interactable->EndInteract(this);
@@ -390,19 +755,27 @@ bool ASurvivalCharacter::Server_StopInteract_Validate() {
 
 #pragma region INVENTORY
 
-USkeletalMeshComponent* ASurvivalCharacter::GetSlotSkeletalMeshComponent(const EEquippableSlot Slot) {
+TMap<EEquippableSlot, UEquippableItem*> ASurvivalCharacter::GetEquippment() const {
+
+	TMap<EEquippableSlot, UEquippableItem*> Equippment;
+
+	for (int32 SlotIndex = 0; SlotIndex < NumEquippableSlots; ++SlotIndex) {
 
-	if(PlayerMeshes.Contains(Slot)) {
+		if (EquippedItems[SlotIndex] != nullptr) {
 
-		return *PlayerMeshes.Find(Slot);
+			Equippment.Add(static_cast<EEquippableSlot>(SlotIndex), EquippedItems[SlotIndex]);
+		}
 	}
 
-	return nullptr;
+	return Equippment;
 }
 
 bool ASurvivalCharacter::EquipItem(class UEquippableItem* Item) {
 
-	EquippedItems.Add(Item->Slot, Item);
+	const int32 SlotIndex = static_cast<int32>(Item->Slot);
+
+	EquippedItems[SlotIndex] = Item;
+	EquippedSlotMask |= (1 << SlotIndex);
 
 	OnEquippmentChanged.Broadcast(Item->Slot, Item);
 
@@ -411,19 +784,16 @@ bool ASurvivalCharacter::EquipItem(class UEquippableItem* Item) {
 
 bool ASurvivalCharacter::UnEquipItem(class UEquippableItem* Item) {
 
-	if( Item != nullptr) {
+	if (Item != nullptr && Item == GetEquippedItem(Item->Slot)) {
 
-		if (EquippedItems.Contains(Item->Slot)) {
+		const int32 SlotIndex = static_cast<int32>(Item->Slot);
 
-			if (Item == *EquippedItems.Find(Item->Slot)) {
+		EquippedItems[SlotIndex] = nullptr;
+		EquippedSlotMask &= ~(1 << SlotIndex);
 
-				EquippedItems.Remove(Item->Slot);
+		OnEquippmentChanged.Broadcast(Item->Slot, nullptr);
 
-				OnEquippmentChanged.Broadcast(Item->Slot, nullptr);
-
-				return true;
-			}
-		}
+		return true;
 	}
 
 	return false;
@@ -433,11 +803,11 @@ bool ASurvivalCharacter::EquipGear(class UGearItem* Gear) {
 
 	if (Gear != nullptr) {
 
-		if (USkeletalMeshComponent* GearMesh = *PlayerMeshes.Find(Gear->Slot)) {
+		ApplyGearAppearance(Gear->Slot, Gear);
 
-			GearMesh->SetSkeletalMesh(Gear->GetGearMesh());
-			// update the last one
-			GearMesh->SetMaterial(GearMesh->GetMaterials().Num() - 1, Gear->MaterialInstance);
+		if (HasAuthority()) {
+
+			EquipmentAppearance.Gear[static_cast<int32>(Gear->Slot)] = Gear->GetClass();
 		}
 	}
 
@@ -446,24 +816,183 @@ bool ASurvivalCharacter::EquipGear(class UGearItem* Gear) {
 
 bool ASurvivalCharacter::UnEquipGear(const EEquippableSlot Slot) {
 
-	if (USkeletalMeshComponent* GearMesh = *PlayerMeshes.Find(Slot)) {
+	if (HasAuthority()) {
 
-		if (USkeletalMesh* BodyMesh = *NakedMeshes.Find(Slot)) {
+		EquipmentAppearance.Gear[static_cast<int32>(Slot)] = nullptr;
+	}
 
-			GearMesh->SetSkeletalMesh(BodyMesh);
-			// Set default material
-			GearMesh->SetMaterial(0, BodyMesh->Materials[0].MaterialInterface);
+	if (GetSlotSkeletalMeshComponent(Slot) != nullptr) {
 
-			return true;
+		ApplyGearAppearance(Slot, nullptr);
+		return true;
+	}
+
+	return false;
+}
+
+void ASurvivalCharacter::ApplyGearAppearance(const EEquippableSlot Slot, const UGearItem* Gear) {
+
+	USkeletalMeshComponent* GearMesh = GetSlotSkeletalMeshComponent(Slot);
+
+	if (GearMesh == nullptr) {
+
+		return;
+	}
+
+	if (Gear != nullptr) {
+
+		GearMesh->SetSkeletalMesh(Gear->GetGearMesh());
+		// update the last one
+		GearMesh->SetMaterial(GearMesh->GetMaterials().Num() - 1, Gear->MaterialInstance);
+	}
+	else if (USkeletalMesh* BodyMesh = NakedMeshes[static_cast<int32>(Slot)]) {
+
+		GearMesh->SetSkeletalMesh(BodyMesh);
+		// Set default material
+		GearMesh->SetMaterial(0, BodyMesh->Materials[0].MaterialInterface);
+	}
+	else {
+		// Some slots do not have naked version (backpack for instance), then set Skeletel mesh to nullptr
+		GearMesh->SetSkeletalMesh(nullptr);
+	}
+}
+
+void ASurvivalCharacter::OnRep_EquipmentAppearance(const FEquipmentAppearance& OldAppearance) {
+
+	for (int32 SlotIndex = 0; SlotIndex < NumEquippableSlots; ++SlotIndex) {
+
+		const TSubclassOf<UGearItem> GearClass = EquipmentAppearance.Gear[SlotIndex];
+
+		if (!OldAppearance.Gear.IsValidIndex(SlotIndex) || OldAppearance.Gear[SlotIndex] != GearClass) {
+
+			ApplyGearAppearance(static_cast<EEquippableSlot>(SlotIndex), GearClass ? GearClass->GetDefaultObject<UGearItem>() : nullptr);
 		}
-		else {
-			// Some slots do not have naked version (backpack for instance), then set Skeletel mesh to nullptr
-			GearMesh->SetSkeletalMesh(nullptr);
-			return true;
+	}
+
+	RequestGearMeshMerge();
+}
+
+void ASurvivalCharacter::OnGearChanged(const EEquippableSlot Slot, const UEquippableItem* Item) {
+
+	// Weapons and throwables are separate actors, only worn gear is part of the merged mesh
+	if (Slot != EEquippableSlot::EES_PrimaryWeapon && Slot != EEquippableSlot::EES_Throwable) {
+
+		RequestGearMeshMerge();
+	}
+}
+
+bool ASurvivalCharacter::ShouldMergeGearMeshes() const {
+
+	return bMergeGearMeshes && GetNetMode() != NM_DedicatedServer && !IsLocallyControlled() && !IsPendingKillPending();
+}
+
+void ASurvivalCharacter::RequestGearMeshMerge() {
+
+	// Items broadcast the equipment change before the gear mesh is swapped, so wait for the next tick
+	if (!bGearMeshMergePending && ShouldMergeGearMeshes()) {
+
+		bGearMeshMergePending = true;
+		GetWorldTimerManager().SetTimerForNextTick(this, &ASurvivalCharacter::MergeGearMeshes);
+	}
+}
+
+void ASurvivalCharacter::MergeGearMeshes() {
+
+	bGearMeshMergePending = false;
+
+	if (!ShouldMergeGearMeshes() || GetMesh()->SkeletalMesh == nullptr) {
+
+		ClearMergedGearMesh();
+		return;
+	}
+
+	TArray<USkeletalMesh*> SourceMeshes;
+	for (USkeletalMeshComponent* SlotMesh : SlotMeshes) {
+
+		if (SlotMesh != nullptr && SlotMesh->SkeletalMesh != nullptr) {
+
+			SourceMeshes.Add(SlotMesh->SkeletalMesh);
 		}
 	}
 
-	return false;
+	USurvivalGameInstance* GameInstance = GetGameInstance<USurvivalGameInstance>();
+	USkeletalMesh* MergedMesh = GameInstance ? GameInstance->GetMergedCharacterMesh(SourceMeshes, GetMesh()->SkeletalMesh->Skeleton) : nullptr;
+
+	if (MergedMesh == nullptr) {
+
+		ClearMergedGearMesh();
+		return;
+	}
+
+	MergedGearMesh->SetSkeletalMesh(MergedMesh, false);
+	MergedGearMesh->EmptyOverrideMaterials();
+
+	// Gear material instances override the source material, sections sharing a material got merged into one
+	for (USkeletalMeshComponent* GearMesh : SlotMeshes) {
+
+		if (GearMesh == nullptr || GearMesh->SkeletalMesh == nullptr) {
+
+			continue;
+		}
+
+		for (int32 MaterialIndex = 0; MaterialIndex < GearMesh->OverrideMaterials.Num(); ++MaterialIndex) {
+
+			UMaterialInterface* OverrideMaterial = GearMesh->OverrideMaterials[MaterialIndex];
+
+			if (OverrideMaterial == nullptr || !GearMesh->SkeletalMesh->Materials.IsValidIndex(MaterialIndex)) {
+
+				continue;
+			}
+
+			const UMaterialInterface* SourceMaterial = GearMesh->SkeletalMesh->Materials[MaterialIndex].MaterialInterface;
+			const int32 MergedIndex = MergedMesh->Materials.IndexOfByPredicate([SourceMaterial](const FSkeletalMaterial& Material) { return Material.MaterialInterface == SourceMaterial; });
+
+			if (MergedIndex != INDEX_NONE) {
+
+				MergedGearMesh->SetMaterial(MergedIndex, OverrideMaterial);
+			}
+		}
+	}
+
+	if (!bGearMeshesMerged) {
+
+		// The separate meshes stay for collision and hit bones, they are just not drawn
+		for (USkeletalMeshComponent* SlotMesh : SlotMeshes) {
+
+			if (SlotMesh != nullptr) {
+
+				SlotMesh->SetVisibility(false);
+			}
+		}
+
+		MergedGearMesh->SetVisibility(true);
+		GetMesh()->VisibilityBasedAnimTickOption = DefaultAnimTickOption;
+
+		bGearMeshesMerged = true;
+		INC_DWORD_STAT(STAT_CharactersWithMergedGear);
+	}
+}
+
+void ASurvivalCharacter::ClearMergedGearMesh() {
+
+	if (!bGearMeshesMerged) {
+
+		return;
+	}
+
+	for (USkeletalMeshComponent* SlotMesh : SlotMeshes) {
+
+		if (SlotMesh != nullptr) {
+
+			SlotMesh->SetVisibility(true);
+		}
+	}
+
+	MergedGearMesh->SetVisibility(false);
+	MergedGearMesh->SetSkeletalMesh(nullptr);
+
+	bGearMeshesMerged = false;
+	DEC_DWORD_STAT(STAT_CharactersWithMergedGear);
 }
 
 bool ASurvivalCharacter::EquipWeapon(class UWeaponItem* WeaponItem) {
@@ -476,19 +1005,33 @@ bool ASurvivalCharacter::EquipWeapon(class UWeaponItem* WeaponItem) {
 		 
 		if (EquippedWeapon != nullptr) UnEquipWeapon();
 
-		FActorSpawnParameters SpawnParams;
-			SpawnParams.bNoFail = true;
-			SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-			SpawnParams.Owner = SpawnParams.Instigator = this;
+		// Reuse the weapon actor from the last time this weapon class was equipped
+		AWeaponActor* NewWeapon = WeaponCache.FindRef(WeaponItem->WeaponClass);
 
-		if (AWeaponActor* NewWeapon = GetWorld()->SpawnActor<AWeaponActor>(WeaponItem->WeaponClass, SpawnParams)) {
+		if (NewWeapon == nullptr) {
 
+			FActorSpawnParameters SpawnParams;
+				SpawnParams.bNoFail = true;
+				SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+				SpawnParams.Owner = SpawnParams.Instigator = this;
+
+			NewWeapon = GetWorld()->SpawnActor<AWeaponActor>(WeaponItem->WeaponClass, SpawnParams);
+
+			if (NewWeapon != nullptr) {
+
+				INC_DWORD_STAT(STAT_GameplayObjectsCreated);
+				WeaponCache.Add(WeaponItem->WeaponClass, NewWeapon);
+			}
+		}
+
+		if (NewWeapon != nullptr) {
+
+			NewWeapon->SetNetDormancy(DORM_Awake);
 			NewWeapon->Item = WeaponItem;
 
+			AWeaponActor* OldWeapon = EquippedWeapon;
 			EquippedWeapon = NewWeapon;
-			OnRep_Weapon();
-
-			NewWeapon->OnEquip();
+			OnRep_Weapon(OldWeapon);
 
 			return true;
 		}
@@ -503,11 +1046,13 @@ bool ASurvivalCharacter::UnEquipWeapon() {
 
 		if (EquippedWeapon == nullptr) return false;
 
-		EquippedWeapon->OnUnEquip();
-		EquippedWeapon->Destroy();
+		AWeaponActor* OldWeapon = EquippedWeapon;
 		EquippedWeapon = nullptr;
 
-		OnRep_Weapon();
+		OnRep_Weapon(OldWeapon);
+
+		// Keep the actor around for the next equip, it does not need to replicate until then
+		OldWeapon->SetNetDormancy(DORM_DormantAll);
 		return true;
 	}
 
@@ -586,6 +1131,7 @@ void ASurvivalCharacter::DropItem(class UItem* Item, const int32 Quantity) {
 
 			if (APickup* Pickup = GetWorld()->SpawnActor<APickup>(PickupClass, SpawnTransform, SpawnParams)) {
 
+				INC_DWORD_STAT(STAT_GameplayObjectsCreated);
 				Pickup->InitializePickup(Item->GetClass(), DroppedQuantity);
 			}
 		}
@@ -698,10 +1244,18 @@ void ASurvivalCharacter::SetLootingSource(class UInventoryComponent* NewLootingS
 
 		if (NewLootingSource != nullptr) {
 
+			// Dormant loot containers only replicate their items to the looter once woken up
+			if (NewLootingSource->GetOwner() != nullptr) {
+
+				NewLootingSource->GetOwner()->FlushNetDormancy();
+			}
+
 			// Looting player keeps their body alive for an extra 2 minuts to provide enought time to loot their items
-			if (ASurvivalCharacter* Character = Cast<ASurvivalCharacter>(NewLootingSource->GetOwner())) {
+			AActor* LootOwner = NewLootingSource->GetOwner();
 
-				Character->SetLifeSpan(120.f);
+			if (Cast<ASurvivalCharacter>(LootOwner) || Cast<ASurvivalCorpse>(LootOwner)) {
+
+				LootOwner->SetLifeSpan(120.f);
 			}
 		}
 
@@ -755,18 +1309,35 @@ void ASurvivalCharacter::OnRep_Killer() {
 	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 	GetCapsuleComponent()->SetCollisionResponseToAllChannels(ECR_Ignore);
 	GetMovementComponent()->SetIsReplicated(false);
+	GetCharacterMovement()->DisableMovement();
+	GetCharacterMovement()->SetComponentTickEnabled(false);
+
+	if (ASurvivalGameStateBase* GameState = GetWorld()->GetGameState<ASurvivalGameStateBase>()) {
+
+		GameState->GetRagdollBudget()->RegisterRagdoll(GetMesh());
+	}
 
 	DeadBodyInteractionComponent->Activate();
 
 	// Unequip all equipment to make items visible in inventory again
 	if (HasAuthority()) {
 
-		TArray<UEquippableItem*> Equipment;
-		EquippedItems.GenerateValueArray(Equipment);
+		// Copy, unequipping clears the slots we iterate
+		TArray<UEquippableItem*> Equipment = EquippedItems;
 
 		for (auto& EquippedItem : Equipment) {
 
-			EquippedItem->SetEquipped(false);
+			if (EquippedItem != nullptr) {
+
+				EquippedItem->SetEquipped(false);
+			}
+		}
+
+		SetReplicateMovement(false);
+
+		if (CorpseClass != nullptr) {
+
+			GetWorldTimerManager().SetTimer(TimerHandle_ConvertToCorpse, this, &ASurvivalCharacter::ConvertToCorpse, FMath::Max(CorpseConversionDelay, KINDA_SMALL_NUMBER), false);
 		}
 	}
 
@@ -791,6 +1362,49 @@ void ASurvivalCharacter::OnRep_Killer() {
 	OnDeath();
 }
 
+void ASurvivalCharacter::ConvertToCorpse() {
+
+	if (!HasAuthority() || CorpseClass == nullptr || IsPendingKillPending()) {
+
+		return;
+	}
+
+	const FTransform SpawnTransform = GetMesh()->GetComponentTransform();
+
+	// Owned by our controller, the dead player's machine picks the corpse up as its view target
+	ASurvivalCorpse* Corpse = GetWorld()->SpawnActorDeferred<ASurvivalCorpse>(CorpseClass, SpawnTransform, GetController(), nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+
+	if (Corpse == nullptr) {
+
+		return;
+	}
+
+	INC_DWORD_STAT(STAT_GameplayObjectsCreated);
+
+	Corpse->InitFromCharacter(this);
+	Corpse->FinishSpawning(SpawnTransform);
+	Corpse->SetLifeSpan(GetLifeSpan());
+
+	// Whoever is looting us keeps looting, now from the corpse
+	for (ASurvivalCharacter* Looter : TActorRange<ASurvivalCharacter>(GetWorld())) {
+
+		if (Looter->GetLootSource() == InventoryComponent) {
+
+			Looter->SetLootingSource(Corpse->GetInventoryComponent());
+		}
+	}
+
+	APlayerController* DeadPlayerController = Cast<APlayerController>(GetController());
+
+	Destroy();
+
+	// Unpossessing reset the view target to the controller
+	if (DeadPlayerController != nullptr) {
+
+		DeadPlayerController->SetViewTarget(Corpse);
+	}
+}
+
 void ASurvivalCharacter::KilledSelf(struct FDamageEvent const& DamageEvent, const AActor* DamageCauser) {
 
 	Killer = this;
@@ -799,35 +1413,114 @@ void ASurvivalCharacter::KilledSelf(struct FDamageEvent const& DamageEvent, cons
 
 void ASurvivalCharacter::KilledBy(struct FDamageEvent const& DamageEvent, const class AController* EventInstigator, const AActor* DamageCauser) {
 
-	if (EventInstigator != nullptr) {
+	// The killer may have died or left in the meantime, we still have to die
+	ASurvivalCharacter* TempKiller = EventInstigator ? Cast<ASurvivalCharacter>(EventInstigator->GetPawn()) : nullptr;
 
-		if (auto TempKiller = Cast<ASurvivalCharacter>(EventInstigator->GetPawn())) {
+	if (TempKiller == nullptr) {
 
-			Killer = TempKiller;
-			OnRep_Killer();
-		}
+		KilledSelf(DamageEvent, DamageCauser);
+		return;
 	}
+
+	Killer = TempKiller;
+	OnRep_Killer();
 }
 
 float  ASurvivalCharacter::TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) {
 
 	Super::TakeDamage(Damage, DamageEvent, EventInstigator, DamageCauser);
 
-	const float DeltaDamage = ModifyHealth(-Damage);
+	if (Damage <= 0.f || !IsAlive()) {
+
+		return 0.f;
+	}
+
+	float QueuedDamage = 0.f;
+	FDamageContribution* Contribution = nullptr;
+
+	for (FDamageContribution& Pending : PendingDamage) {
+
+		QueuedDamage += Pending.Damage;
+
+		if (Pending.EventInstigator == EventInstigator) {
+
+			Contribution = &Pending;
+		}
+	}
+
+	if (Contribution == nullptr) {
+
+		Contribution = &PendingDamage.AddDefaulted_GetRef();
+		Contribution->EventInstigator = EventInstigator;
+	}
+
+	Contribution->DamageCauser = DamageCauser;
+	Contribution->DamageTypeClass = DamageEvent.DamageTypeClass;
+	Contribution->Damage += Damage;
+	Contribution->Hits++;
+
+	// A shotgun blast hits several times within a frame, the UI and the death path should see it once
+	if (!bDamageResolvePending) {
+
+		bDamageResolvePending = true;
+		GetWorldTimerManager().SetTimerForNextTick(this, &ASurvivalCharacter::ResolvePendingDamage);
+	}
+
+	return FMath::Clamp(Health - QueuedDamage, 0.f, Damage);
+}
+
+void ASurvivalCharacter::ResolvePendingDamage() {
+
+	bDamageResolvePending = false;
+
+	if (PendingDamage.Num() == 0 || !IsAlive()) {
+
+		PendingDamage.Reset();
+		return;
+	}
+
+	float TotalDamage = 0.f;
+	int32 TotalHits = 0;
+	const FDamageContribution* Biggest = &PendingDamage[0];
+
+	for (const FDamageContribution& Contribution : PendingDamage) {
+
+		TotalDamage += Contribution.Damage;
+		TotalHits += Contribution.Hits;
+
+		if (Contribution.Damage > Biggest->Damage) {
+
+			Biggest = &Contribution;
+		}
+
+		UE_LOG(LogSurvivalCombat, Verbose, TEXT("  %s: %.1f damage in %d hits with %s (%s)"),
+			*GetNameSafe(Contribution.EventInstigator.Get()), Contribution.Damage, Contribution.Hits, *GetNameSafe(Contribution.DamageCauser.Get()), *GetNameSafe(*Contribution.DamageTypeClass));
+	}
+
+	const float OldHealth = Health;
+	ModifyHealth(-TotalDamage);
+
+	UE_LOG(LogSurvivalCombat, Log, TEXT("%s took %.1f damage in %d hits from %d instigators, health %.1f -> %.1f"),
+		*GetName(), TotalDamage, TotalHits, PendingDamage.Num(), OldHealth, Health);
 
 	if (Health <= 0) {
 
-		if (EventInstigator != GetController()) {
+		AController* KillInstigator = Biggest->EventInstigator.Get();
+		const FDamageEvent KillEvent(Biggest->DamageTypeClass);
+
+		UE_LOG(LogSurvivalCombat, Log, TEXT("%s killed by %s with %s"), *GetName(), *GetNameSafe(KillInstigator), *GetNameSafe(Biggest->DamageCauser.Get()));
+
+		if (KillInstigator != GetController()) {
 
-			KilledBy(DamageEvent,EventInstigator, DamageCauser);
+			KilledBy(KillEvent, KillInstigator, Biggest->DamageCauser.Get());
 		}
 		else {
 
-			KilledSelf(DamageEvent, this);
+			KilledSelf(KillEvent, this);
 		}
 	}
 
-	return DeltaDamage;
+	PendingDamage.Reset();
 }
 
 #pragma endregion HEALTH
@@ -841,34 +1534,79 @@ void ASurvivalCharacter::BeginMeleeAttack() {
 		// If passed the time of at lest montage duration
 		if (GetWorld()->TimeSince(LastMeleeAttackTime) > MeleeAttackMontage->GetPlayLength()) {
 
-			FVector StartTrace = CameraComp->GetComponentLocation();
-			FVector EndTrace = (CameraComp->GetComponentRotation().Vector() * MeleeAttackDistance) + StartTrace;
+			PlayAnimMontage(MeleeAttackMontage);
 
-			FHitResult HitResult;
-			FCollisionShape Shape = FCollisionShape::MakeSphere(15.f);
+			Server_MeleeAttack();
 
-			FCollisionQueryParams QueryParams;
-				QueryParams.bTraceComplex = true;
-				QueryParams.AddIgnoredActor(this);
+			GetWorldTimerManager().SetTimer(TimerHandle_MeleeWindow, this, &ASurvivalCharacter::StartMeleeSwing, FMath::Max(MeleeActiveStart, KINDA_SMALL_NUMBER), false);
 
-			PlayAnimMontage(MeleeAttackMontage);
+			LastMeleeAttackTime = GetWorld()->GetTimeSeconds();
+		}
+	}
+}
 
-			if (GetWorld()->SweepSingleByChannel(HitResult, StartTrace, EndTrace, FQuat(), COLLISION_WEAPON, Shape, QueryParams)) {
+void ASurvivalCharacter::StartMeleeSwing() {
 
-				if (ASurvivalCharacter* HitPlayer = Cast<ASurvivalCharacter>(HitResult.GetActor())) {
+	LastMeleeSocketLocation = GetMesh()->GetSocketLocation(MeleeSocketName);
+	MeleeSwingCycles = 0;
+	MeleeSwingHits.Reset();
 
-					if (ASurvivalPlayerController* PC = Cast<ASurvivalPlayerController>(GetController())) {
+	MeleeTickFunction.SetTickFunctionEnable(MeleeTickFunction.IsTickFunctionRegistered());
 
-						PC->OnHitPlayer();
-					}
-				}
-			}
+	GetWorldTimerManager().SetTimer(TimerHandle_MeleeWindow, this, &ASurvivalCharacter::EndMeleeSwing, FMath::Max(MeleeActiveEnd - MeleeActiveStart, KINDA_SMALL_NUMBER), false);
+}
 
-			Server_MeleeAttack(HitResult);
+void ASurvivalCharacter::EndMeleeSwing() {
 
-			LastMeleeAttackTime = GetWorld()->GetTimeSeconds();
+	GetWorldTimerManager().ClearTimer(TimerHandle_MeleeWindow);
+
+	if (MeleeTickFunction.IsTickFunctionEnabled()) {
+
+		MeleeTickFunction.SetTickFunctionEnable(false);
+
+		SET_FLOAT_STAT(STAT_MeleeSwingCost, FPlatformTime::ToMilliseconds(MeleeSwingCycles));
+	}
+}
+
+void ASurvivalCharacter::TickMeleeSwing(float DeltaTime) {
+
+	SCOPE_CYCLE_COUNTER(STAT_MeleeSwingSweep);
+	INC_DWORD_STAT(STAT_MeleeSweeps);
+
+	const uint32 StartCycles = FPlatformTime::Cycles();
+
+	const FVector SocketLocation = GetMesh()->GetSocketLocation(MeleeSocketName);
+
+	// Simple collision only, physics asset bodies are plenty accurate for a fist or a blade
+	TArray<FHitResult> HitResults;
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(MeleeSwing), false, this);
+
+	GetWorld()->SweepMultiByChannel(HitResults, LastMeleeSocketLocation, SocketLocation, FQuat::Identity, COLLISION_WEAPON, FCollisionShape::MakeSphere(MeleeHitRadius), QueryParams);
+
+	for (const FHitResult& HitResult : HitResults) {
+
+		AActor* HitActor = HitResult.GetActor();
+
+		if (HitActor == nullptr || MeleeSwingHits.Contains(HitActor)) {
+
+			continue;
 		}
+
+		MeleeSwingHits.Add(HitActor);
+
+		if (Cast<ASurvivalCharacter>(HitActor)) {
+
+			if (ASurvivalPlayerController* PC = Cast<ASurvivalPlayerController>(GetController())) {
+
+				PC->OnHitPlayer();
+			}
+		}
+
+		Server_MeleeHit(HitResult);
 	}
+
+	LastMeleeSocketLocation = SocketLocation;
+	MeleeSwingCycles += FPlatformTime::Cycles() - StartCycles;
 }
 
 void ASurvivalCharacter::MulticastPlayMeleeFX_Implementation() {
@@ -882,35 +1620,89 @@ void ASurvivalCharacter::MulticastPlayMeleeFX_Implementation() {
 	}
 }
 
-void ASurvivalCharacter::Server_MeleeAttack_Implementation(const FHitResult& MeleeHit) {
-
+void ASurvivalCharacter::Server_MeleeAttack_Implementation() {
 
-	if (GetWorld()->TimeSince(LastMeleeAttackTime) > MeleeAttackMontage->GetPlayLength() && (GetActorLocation() - MeleeHit.ImpactPoint).Size() <= MeleeAttackDistance) {
+	if (MeleeAttackMontage && GetWorld()->TimeSince(LastMeleeAttackTime) > MeleeAttackMontage->GetPlayLength()) {
 
 		MulticastPlayMeleeFX();
 
-		if (MeleeHit.GetActor() != nullptr) {
+		MeleeServerHits.Reset();
 
-			UGameplayStatics::ApplyPointDamage(MeleeHit.GetActor(), MeleeAttackDamage, (MeleeHit.TraceStart - MeleeHit.TraceEnd).GetSafeNormal(), MeleeHit, GetController(), this, MeleeDamageTypeClass->StaticClass());
-		}
+		LastMeleeAttackTime = GetWorld()->GetTimeSeconds();
 	}
-
-	LastMeleeAttackTime = GetWorld()->GetTimeSeconds();
 }
 
-bool ASurvivalCharacter::Server_MeleeAttack_Validate(const FHitResult& MeleeHit) {
+bool ASurvivalCharacter::Server_MeleeAttack_Validate() {
 	return true;
 }
 
+void ASurvivalCharacter::Server_MeleeHit_Implementation(const FHitResult& MeleeHit) {
+
+	SCOPE_CYCLE_COUNTER(STAT_MeleeHitValidation);
+
+	AActor* HitActor = MeleeHit.GetActor();
+	UPrimitiveComponent* HitComponent = MeleeHit.GetComponent();
+
+	if (HitActor == nullptr || HitComponent == nullptr || HitComponent->GetOwner() != HitActor || MeleeServerHits.Contains(HitActor) || !MeleeDamageTypeClass) {
+
+		return;
+	}
+
+	// The swing started on the client half a round trip before it did here
+	if (GetWorld()->TimeSince(LastMeleeAttackTime) > MeleeActiveEnd + 0.5f) {
+
+		return;
+	}
+
+	// Both ends of the swept segment have to be within reach of where the server sees us
+	const float MaxReachSquared = FMath::Square(MeleeAttackDistance + MeleeHitTolerance);
+
+	if (FVector::DistSquared(GetActorLocation(), MeleeHit.TraceStart) > MaxReachSquared || FVector::DistSquared(GetActorLocation(), MeleeHit.TraceEnd) > MaxReachSquared) {
+
+		return;
+	}
+
+	// Characters are checked against their capsule, the server does not necessarily update their pose
+	UPrimitiveComponent* ValidationComponent = HitComponent;
+
+	if (ACharacter* HitCharacter = Cast<ACharacter>(HitActor)) {
+
+		ValidationComponent = HitCharacter->GetCapsuleComponent();
+	}
+
+	// Re-run the sweep against the victim alone instead of the whole scene
+	FHitResult ServerHit;
+
+	if (!ValidationComponent->SweepComponent(ServerHit, MeleeHit.TraceStart, MeleeHit.TraceEnd, FQuat::Identity, FCollisionShape::MakeSphere(MeleeHitRadius + MeleeHitTolerance))) {
+
+		return;
+	}
+
+	MeleeServerHits.Add(HitActor);
+
+	UGameplayStatics::ApplyPointDamage(HitActor, MeleeAttackDamage, (MeleeHit.TraceEnd - MeleeHit.TraceStart).GetSafeNormal(), MeleeHit, GetController(), this, MeleeDamageTypeClass);
+}
+
+bool ASurvivalCharacter::Server_MeleeHit_Validate(const FHitResult& MeleeHit) {
+	return !MeleeHit.TraceStart.ContainsNaN() && !MeleeHit.TraceEnd.ContainsNaN();
+}
+
 #pragma endregion COMBAT_MELEE
 
 #pragma region WEAPON
 
-void ASurvivalCharacter::OnRep_Weapon() {
+void ASurvivalCharacter::OnRep_Weapon(AWeaponActor* OldWeapon) {
+
+	if (OldWeapon != nullptr && OldWeapon != EquippedWeapon && OldWeapon->IsAttachedToPawn()) {
+
+		OldWeapon->OnUnEquip();
+	}
 
 	if (EquippedWeapon != nullptr) {
 
 		EquippedWeapon->OnEquip();
+
+		ApplySignificanceToWeapon();
 	}
 }
 
@@ -968,14 +1760,7 @@ void ASurvivalCharacter::StartReload() {
 
 UThrowableItem* ASurvivalCharacter::GetThrowableItem() const {
 
-	UThrowableItem* EquippedThrowable = nullptr;
-
-	if (EquippedItems.Contains(EEquippableSlot::EES_Throwable)) {
-
-		EquippedThrowable = Cast< UThrowableItem>(*EquippedItems.Find(EEquippableSlot::EES_Throwable));
-	}
-
-	return EquippedThrowable;
+	return Cast<UThrowableItem>(GetEquippedItem(EEquippableSlot::EES_Throwable));
 }
 
 void ASurvivalCharacter::MulticastPlayThrowableTossFX_Implementation(UAnimMontage* MontageToPlay) {
@@ -1016,7 +1801,8 @@ void ASurvivalCharacter::UseThrowable() {
 				// To make sure UI on client side updades correctly
 				if (ThrowableItem->GetQuantity() <= 1) {
 
-					EquippedItems.Remove(EEquippableSlot::EES_Throwable);
+					EquippedItems[static_cast<int32>(EEquippableSlot::EES_Throwable)] = nullptr;
+					EquippedSlotMask &= ~(1 << static_cast<int32>(EEquippableSlot::EES_Throwable));
 					OnEquippmentChanged.Broadcast(EEquippableSlot::EES_Throwable, nullptr);
 				}
 
@@ -1057,6 +1843,7 @@ void ASurvivalCharacter::SpawnThrowable() {
 
 				if (AThrowableWeapon* ThrowableWeapon = GetWorld()->SpawnActor<AThrowableWeapon>(ThrowableItem->ThrowableWeaponClass, FTransform(CamRot, CamLoc), SpawnParams)) {
 
+					INC_DWORD_STAT(STAT_GameplayObjectsCreated);
 					MulticastPlayThrowableTossFX(ThrowableItem->ThrowableTossAnim);
 				}
 			}
@@ -1,16 +1,16 @@
 // All rights reserved Dominik Pavlicek
 
 #include "SurvivalPlayerController.h"
+#include "SurvivalGame.h"
 #include "Character/SurvivalCharacter.h"
+#include "Components/RecoilComponent.h"
+#include "GameFramework/SurvivalNetAccounting.h"
 #include "Net/UnrealNetwork.h"
+#include "SignificanceManager.h"
 
 ASurvivalPlayerController::ASurvivalPlayerController() {
 
-	RecoilBumpAmount = FVector2D(0.f, 0.f);
-	RecoilResetAmount = FVector2D(0.f, 0.f);
-	CurrentRecoilSpeed = 0.f;
-	CurrentRecoilResetSpeed = 0.f;
-	LastRecoilTime = 0.f;
+	Recoil = CreateDefaultSubobject<URecoilComponent>(FName("Recoil"));
 }
 
 void ASurvivalPlayerController::SetupInputComponent() {
@@ -23,65 +23,40 @@ void ASurvivalPlayerController::SetupInputComponent() {
 	InputComponent->BindAction("Reload", IE_Pressed, this, &ASurvivalPlayerController::StartReload);
 }
 
-void ASurvivalPlayerController::Turn(float Rate)
-{
-	//If the player has moved their camera to compensate for recoil we need this to cancel out the recoil reset effect
-	if (!FMath::IsNearlyZero(RecoilResetAmount.X, 0.01f))
-	{
-		if (RecoilResetAmount.X > 0.f && Rate > 0.f)
-		{
-			RecoilResetAmount.X = FMath::Max(0.f, RecoilResetAmount.X - Rate);
-		}
-		else if (RecoilResetAmount.X < 0.f && Rate < 0.f)
-		{
-			RecoilResetAmount.X = FMath::Min(0.f, RecoilResetAmount.X - Rate);
-		}
-	}
+void ASurvivalPlayerController::PlayerTick(float DeltaTime) {
 
-	//Apply the recoil over several frames
-	if (!FMath::IsNearlyZero(RecoilBumpAmount.X, 0.1f))
-	{
-		FVector2D LastCurrentRecoil = RecoilBumpAmount;
-		RecoilBumpAmount.X = FMath::FInterpTo(RecoilBumpAmount.X, 0.f, GetWorld()->DeltaTimeSeconds, CurrentRecoilSpeed);
+	Super::PlayerTick(DeltaTime);
 
-		AddYawInput(LastCurrentRecoil.X - RecoilBumpAmount.X);
-	}
-
-	//Slowly reset back to center after recoil is processed
-	FVector2D LastRecoilResetAmount = RecoilResetAmount;
-	RecoilResetAmount.X = FMath::FInterpTo(RecoilResetAmount.X, 0.f, GetWorld()->DeltaTimeSeconds, CurrentRecoilResetSpeed);
-	AddYawInput(LastRecoilResetAmount.X - RecoilResetAmount.X);
+	// Rescore remote characters from what this player sees, 'showdebug SignificanceManager' displays the result
+	if (USignificanceManager* SignificanceManager = FSignificanceManagerModule::Get(GetWorld())) {
 
-	AddYawInput(Rate);
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		GetPlayerViewPoint(ViewLocation, ViewRotation);
 
+		const FTransform Viewpoint(ViewRotation, ViewLocation);
+		SignificanceManager->Update(TArrayView<const FTransform>(&Viewpoint, 1));
+	}
 }
 
-void ASurvivalPlayerController::LookUp(float Rate) {
-
-	if (!FMath::IsNearlyZero(RecoilResetAmount.Y, 0.01f)) {
+bool ASurvivalPlayerController::CallRemoteFunction(UFunction* Function, void* Parameters, struct FOutParmRec* OutParms, FFrame* Stack) {
 
-		if (RecoilResetAmount.Y > 0.f && Rate > 0.f) {
+	FSurvivalNetAccounting::FScopedRemoteFunction ScopedAccounting(this, Function);
 
-			RecoilResetAmount.Y = FMath::Max(0.f, RecoilResetAmount.Y - Rate);
-		}
-		else if (RecoilResetAmount.Y < 0.f && Rate > 0.f) {
+	return Super::CallRemoteFunction(Function, Parameters, OutParms, Stack);
+}
 
-			RecoilResetAmount.Y = FMath::Min(0.f, RecoilResetAmount.Y - Rate);
-		}
-	}
+void ASurvivalPlayerController::Turn(float Rate) {
 
-	// Apply recoild over frames
-	if (!FMath::IsNearlyZero(RecoilBumpAmount.Y, 0.01f)) {
+	//If the player has moved their camera to compensate for recoil we need this to cancel out the recoil reset effect
+	Recoil->CompensateInput(FVector2D(Rate, 0.f));
 
-		FVector2D LastCurrentRecoil = RecoilBumpAmount;
-		RecoilBumpAmount.Y = FMath::FInterpTo(RecoilBumpAmount.Y, 0.f, GetWorld()->DeltaTimeSeconds, CurrentRecoilSpeed);
+	AddYawInput(Rate);
+}
 
-		AddPitchInput(LastCurrentRecoil.Y - RecoilBumpAmount.Y);
-	}
+void ASurvivalPlayerController::LookUp(float Rate) {
 
-	FVector2D LastRecoildResetAmount = RecoilResetAmount;
-	RecoilResetAmount.Y = FMath::FInterpTo(RecoilResetAmount.Y, 0.f, GetWorld()->DeltaTimeSeconds, CurrentRecoilResetSpeed);
-	AddPitchInput(LastRecoildResetAmount.Y - RecoilResetAmount.Y);
+	Recoil->CompensateInput(FVector2D(0.f, Rate));
 
 	AddPitchInput(Rate);
 }
@@ -141,25 +116,6 @@ bool ASurvivalPlayerController::ServerRespawn_Validate() {
 	return true;
 }
 
-void ASurvivalPlayerController::ApplyRecoil(const FVector2D RecoildAmount, float RecoilSpeed, float RecoilResetSpeed, TSubclassOf<UCameraShake> FireCameraShake) {
-	
-	if (IsLocalPlayerController()) {
-
-		if (PlayerCameraManager != nullptr && FireCameraShake) {
-
-			PlayerCameraManager->PlayCameraShake(FireCameraShake);
-		}
-
-		RecoilBumpAmount += RecoildAmount;
-		RecoilResetAmount -= RecoildAmount;
-
-		CurrentRecoilSpeed = RecoilSpeed;
-		CurrentRecoilResetSpeed = RecoilResetSpeed;
-
-		LastRecoilTime = GetWorld()->GetTimeSeconds();
-	}
-}
-
 void ASurvivalPlayerController::ClientShotHitConfirmed_Implementation() {
 
 	//...
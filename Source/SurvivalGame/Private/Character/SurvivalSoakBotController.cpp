@@ -0,0 +1,260 @@
+// All rights reserved Dominik Pavlicek
+
+
+#include "SurvivalSoakBotController.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+
+#include "Character/SurvivalCharacter.h"
+#include "Components/InteractionComponent.h"
+#include "Components/InventoryComponent.h"
+#include "Items/WeaponItem.h"
+#include "World/LootableActor.h"
+#include "World/Pickup.h"
+#include "World/SurvivalCorpse.h"
+
+ASurvivalSoakBotController::ASurvivalSoakBotController()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = true;
+
+	bWantsPlayerState = true;
+
+	DecisionInterval = 1.f;
+	WanderRadius = 3000.f;
+	LootSearchRadius = 2000.f;
+	EngageRange = 2500.f;
+
+	WanderTarget = FVector::ZeroVector;
+	NextDecisionTime = 0.f;
+	bFiring = false;
+}
+
+void ASurvivalSoakBotController::InitBot(const int32 Seed) {
+
+	Stream.Initialize(Seed);
+
+	// Spread the decisions of all bots over the interval
+	NextDecisionTime = GetWorld()->GetTimeSeconds() + Stream.FRandRange(0.f, DecisionInterval);
+}
+
+void ASurvivalSoakBotController::OnUnPossess() {
+
+	if (ASurvivalCharacter* Character = Cast<ASurvivalCharacter>(GetPawn())) {
+
+		SetFiring(Character, false);
+	}
+
+	CurrentLootTarget = nullptr;
+	CurrentEnemy = nullptr;
+
+	Super::OnUnPossess();
+}
+
+void ASurvivalSoakBotController::Tick(float DeltaTime) {
+
+	Super::Tick(DeltaTime);
+
+	ASurvivalCharacter* Character = Cast<ASurvivalCharacter>(GetPawn());
+
+	if (Character == nullptr || !Character->IsAlive()) {
+
+		return;
+	}
+
+	if (GetWorld()->GetTimeSeconds() >= NextDecisionTime) {
+
+		NextDecisionTime = GetWorld()->GetTimeSeconds() + DecisionInterval;
+		Think(Character);
+	}
+
+	if (CurrentEnemy != nullptr && !CurrentEnemy->IsPendingKill() && CurrentEnemy->IsAlive()) {
+
+		// Stand and shoot, aim at the chest
+		const FVector AimPoint = CurrentEnemy->GetActorLocation() + FVector(0.f, 0.f, 30.f);
+		SetControlRotation((AimPoint - Character->GetPawnViewLocation()).Rotation());
+		return;
+	}
+
+	SetFiring(Character, false);
+
+	FVector Destination = WanderTarget;
+
+	if (CurrentLootTarget != nullptr && !CurrentLootTarget->IsPendingKillPending()) {
+
+		Destination = CurrentLootTarget->GetActorLocation();
+
+		UInteractionComponent* InteractionComp = CurrentLootTarget->FindComponentByClass<UInteractionComponent>();
+		const float InteractRange = InteractionComp ? InteractionComp->GetInteractionDistance() : 0.f;
+
+		if (FVector::DistSquared2D(Destination, Character->GetActorLocation()) <= FMath::Square(InteractRange)) {
+
+			LootTarget(Character);
+			return;
+		}
+	}
+
+	const FVector ToDestination = (Destination - Character->GetActorLocation()).GetSafeNormal2D();
+
+	if (!ToDestination.IsNearlyZero()) {
+
+		SetControlRotation(ToDestination.Rotation());
+		Character->AddMovementInput(ToDestination);
+	}
+}
+
+void ASurvivalSoakBotController::Think(ASurvivalCharacter* Character) {
+
+	EquipAnyWeapon(Character);
+
+	CurrentEnemy = Character->GetEquippedWeapon() != nullptr ? FindEnemy(Character) : nullptr;
+
+	if (CurrentEnemy != nullptr) {
+
+		// Fire in short bursts so the weapon goes through start, refire and stop
+		SetFiring(Character, !bFiring || Stream.FRand() < 0.5f);
+		return;
+	}
+
+	if (CurrentLootTarget == nullptr || CurrentLootTarget->IsPendingKillPending()) {
+
+		CurrentLootTarget = FindLootTarget(Character);
+	}
+
+	if (CurrentLootTarget == nullptr && (FVector::DistSquared2D(WanderTarget, Character->GetActorLocation()) < FMath::Square(200.f) || Stream.FRand() < 0.2f)) {
+
+		const FVector2D Offset = FVector2D(Stream.FRandRange(-1.f, 1.f), Stream.FRandRange(-1.f, 1.f)) * WanderRadius;
+		WanderTarget = Character->GetActorLocation() + FVector(Offset, 0.f);
+	}
+}
+
+AActor* ASurvivalSoakBotController::FindLootTarget(ASurvivalCharacter* Character) const {
+
+	const FVector Location = Character->GetActorLocation();
+
+	AActor* BestTarget = nullptr;
+	float BestDistSq = FMath::Square(LootSearchRadius);
+
+	auto Consider = [&](AActor* Candidate) {
+
+		if (Candidate->IsPendingKillPending()) {
+
+			return;
+		}
+
+		// Skip empty loot sources, pickups have no inventory of their own
+		const UInventoryComponent* Inventory = Candidate->FindComponentByClass<UInventoryComponent>();
+		if (Inventory != nullptr && Inventory->GetItems().Num() == 0) {
+
+			return;
+		}
+
+		const float DistSq = FVector::DistSquared(Location, Candidate->GetActorLocation());
+		if (DistSq < BestDistSq) {
+
+			BestDistSq = DistSq;
+			BestTarget = Candidate;
+		}
+	};
+
+	for (APickup* Pickup : TActorRange<APickup>(GetWorld())) {
+
+		Consider(Pickup);
+	}
+
+	for (ALootableActor* Lootable : TActorRange<ALootableActor>(GetWorld())) {
+
+		Consider(Lootable);
+	}
+
+	for (ASurvivalCorpse* Corpse : TActorRange<ASurvivalCorpse>(GetWorld())) {
+
+		Consider(Corpse);
+	}
+
+	return BestTarget;
+}
+
+ASurvivalCharacter* ASurvivalSoakBotController::FindEnemy(ASurvivalCharacter* Character) const {
+
+	const FVector Location = Character->GetActorLocation();
+
+	ASurvivalCharacter* BestEnemy = nullptr;
+	float BestDistSq = FMath::Square(EngageRange);
+
+	for (ASurvivalCharacter* Other : TActorRange<ASurvivalCharacter>(GetWorld())) {
+
+		if (Other == Character || !Other->IsAlive() || Other->IsPendingKillPending()) {
+
+			continue;
+		}
+
+		const float DistSq = FVector::DistSquared(Location, Other->GetActorLocation());
+		if (DistSq < BestDistSq) {
+
+			BestDistSq = DistSq;
+			BestEnemy = Other;
+		}
+	}
+
+	return BestEnemy;
+}
+
+void ASurvivalSoakBotController::LootTarget(ASurvivalCharacter* Character) {
+
+	if (UInteractionComponent* InteractionComp = CurrentLootTarget->FindComponentByClass<UInteractionComponent>()) {
+
+		InteractionComp->Interact(Character);
+	}
+
+	// Lootables and corpses open a loot source instead of giving the item directly
+	if (UInventoryComponent* LootSource = Character->GetLootSource()) {
+
+		const TArray<UItem*>& Items = LootSource->GetItems();
+
+		if (Items.Num() > 0) {
+
+			if (UItem* Item = Items[Stream.RandHelper(Items.Num())]) {
+
+				Character->LootItem(Item);
+			}
+		}
+
+		Character->SetLootingSource(nullptr);
+	}
+
+	CurrentLootTarget = nullptr;
+}
+
+void ASurvivalSoakBotController::EquipAnyWeapon(ASurvivalCharacter* Character) {
+
+	if (Character->GetEquippedWeapon() != nullptr || Character->GetPlayerInventory() == nullptr) {
+
+		return;
+	}
+
+	for (UItem* Item : Character->GetPlayerInventory()->GetItems()) {
+
+		if (UWeaponItem* WeaponItem = Cast<UWeaponItem>(Item)) {
+
+			WeaponItem->Use(Character);
+			return;
+		}
+	}
+}
+
+void ASurvivalSoakBotController::SetFiring(ASurvivalCharacter* Character, const bool bNewFiring) {
+
+	if (bFiring == bNewFiring) {
+
+		return;
+	}
+
+	bFiring = bNewFiring;
+
+	if (bFiring) {
+
+		Character->StartFire();
+	}
+	else Character->StopFire();
+}
@@ -0,0 +1,251 @@
+// All rights reserved Dominik Pavlicek
+
+
+#include "AreaDamageComponent.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/DamageType.h"
+#include "Components/CapsuleComponent.h"
+#include "HAL/IConsoleManager.h"
+
+#include "SurvivalGame.h"
+#include "Character/SurvivalCharacter.h"
+#include "GameFramework/SurvivalGameStateBase.h"
+
+DECLARE_CYCLE_STAT(TEXT("Area Damage Query"), STAT_AreaDamageQuery, STATGROUP_SurvivalGame);
+DECLARE_CYCLE_STAT(TEXT("Area Damage Resolve"), STAT_AreaDamageResolve, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Area Damage Explosions"), STAT_AreaDamageExplosions, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Area Damage Occlusion Traces"), STAT_AreaDamageTraces, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Area Damage Victims"), STAT_AreaDamageVictims, STATGROUP_SurvivalGame);
+
+UAreaDamageComponent::UAreaDamageComponent() {
+
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	CellSize = 1000.f;
+	OcclusionChannel = ECC_Visibility;
+	SpatialIndexFrame = 0;
+}
+
+FIntPoint UAreaDamageComponent::GetCell(const FVector& Location) const {
+
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+void UAreaDamageComponent::UpdateSpatialIndex() {
+
+	if (SpatialIndexFrame == GFrameCounter) {
+
+		return;
+	}
+
+	SpatialIndexFrame = GFrameCounter;
+
+	for (auto& Cell : CharacterGrid) {
+
+		Cell.Value.Reset();
+	}
+
+	for (ASurvivalCharacter* Character : TActorRange<ASurvivalCharacter>(GetWorld())) {
+
+		if (Character->IsAlive() && !Character->IsPendingKillPending()) {
+
+			CharacterGrid.FindOrAdd(GetCell(Character->GetActorLocation())).Add(Character);
+		}
+	}
+}
+
+void UAreaDamageComponent::GatherVictims(const FVector& Origin, const float Radius, TArray<ASurvivalCharacter*>& OutVictims) const {
+
+	// Characters are bucketed by their location, pad by a capsule so ones standing on a cell border are not missed
+	const float Padding = 100.f;
+	const FIntPoint MinCell = GetCell(Origin - FVector(Radius + Padding));
+	const FIntPoint MaxCell = GetCell(Origin + FVector(Radius + Padding));
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X) {
+
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y) {
+
+			if (const TArray<ASurvivalCharacter*>* Characters = CharacterGrid.Find(FIntPoint(X, Y))) {
+
+				for (ASurvivalCharacter* Character : *Characters) {
+
+					const FBox Bounds = Character->GetCapsuleComponent()->Bounds.GetBox();
+
+					if (Bounds.ComputeSquaredDistanceToPoint(Origin) <= FMath::Square(Radius)) {
+
+						OutVictims.Add(Character);
+					}
+				}
+			}
+		}
+	}
+}
+
+void UAreaDamageComponent::ApplyAreaDamage(const FVector& Origin, const FRadialDamageParams& Params, TSubclassOf<UDamageType> DamageTypeClass, AActor* DamageCauser, AController* InstigatedBy, const bool bDryRun) {
+
+	if (GetOwnerRole() != ROLE_Authority) {
+
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_AreaDamageQuery);
+	INC_DWORD_STAT(STAT_AreaDamageExplosions);
+
+	UpdateSpatialIndex();
+
+	TArray<ASurvivalCharacter*> Victims;
+	GatherVictims(Origin, Params.GetMaxRadius(), Victims);
+
+	FPendingExplosion& Explosion = PendingExplosions.AddDefaulted_GetRef();
+		Explosion.Origin = Origin;
+		Explosion.Params = Params;
+		Explosion.DamageTypeClass = DamageTypeClass ? DamageTypeClass : TSubclassOf<UDamageType>(UDamageType::StaticClass());
+		Explosion.DamageCauser = DamageCauser;
+		Explosion.InstigatedBy = InstigatedBy;
+		Explosion.IssueFrame = GFrameCounter;
+		Explosion.bDryRun = bDryRun;
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(AreaDamageOcclusion), false, DamageCauser);
+
+	for (ASurvivalCharacter* Victim : Victims) {
+
+		const FVector ClosestPoint = Victim->GetCapsuleComponent()->Bounds.GetBox().GetClosestPointTo(Origin);
+
+		FPendingVictim& PendingVictim = Explosion.Victims.AddDefaulted_GetRef();
+			PendingVictim.Character = Victim;
+			PendingVictim.ClosestPoint = ClosestPoint;
+			PendingVictim.Distance = FVector::Dist(Origin, ClosestPoint);
+			// Aim at the capsule center, a hand sticking out of cover should not take the full blast
+			PendingVictim.OcclusionTrace = GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, Origin, Victim->GetActorLocation(), OcclusionChannel, QueryParams);
+	}
+
+	INC_DWORD_STAT_BY(STAT_AreaDamageTraces, Victims.Num());
+
+	SetComponentTickEnabled(true);
+}
+
+void UAreaDamageComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) {
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	ResolveExplosions();
+
+	if (PendingExplosions.Num() == 0) {
+
+		SetComponentTickEnabled(false);
+	}
+}
+
+void UAreaDamageComponent::ResolveExplosions() {
+
+	SCOPE_CYCLE_COUNTER(STAT_AreaDamageResolve);
+
+	UWorld* World = GetWorld();
+	int32 Resolved = 0;
+
+	// Explosions are queued in frame order, traces of the current frame are not done yet
+	for (; Resolved < PendingExplosions.Num() && PendingExplosions[Resolved].IssueFrame < GFrameCounter; ++Resolved) {
+
+		const FPendingExplosion& Explosion = PendingExplosions[Resolved];
+
+		for (const FPendingVictim& PendingVictim : Explosion.Victims) {
+
+			ASurvivalCharacter* Victim = PendingVictim.Character.Get();
+
+			if (Victim == nullptr || !Victim->IsAlive()) {
+
+				continue;
+			}
+
+			FTraceDatum OcclusionResult;
+			bool bOccluded = false;
+
+			if (World->QueryTraceData(PendingVictim.OcclusionTrace, OcclusionResult)) {
+
+				for (const FHitResult& Hit : OcclusionResult.OutHits) {
+
+					bOccluded |= (Hit.bBlockingHit && Hit.GetActor() != Victim);
+				}
+			}
+			else {
+
+				// Trace data is kept for one frame only, a hitch can make us miss it
+				FHitResult Hit;
+				FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(AreaDamageOcclusion), false, Explosion.DamageCauser.Get());
+				bOccluded = World->LineTraceSingleByChannel(Hit, Explosion.Origin, Victim->GetActorLocation(), OcclusionChannel, QueryParams) && Hit.GetActor() != Victim;
+			}
+
+			if (bOccluded || Explosion.bDryRun) {
+
+				continue;
+			}
+
+			const float DamageScale = Explosion.Params.GetDamageScale(PendingVictim.Distance);
+
+			if (DamageScale <= 0.f) {
+
+				continue;
+			}
+
+			const float Damage = FMath::Lerp(Explosion.Params.MinimumDamage, Explosion.Params.BaseDamage, DamageScale);
+
+			const FVector ShotDirection = (PendingVictim.ClosestPoint - Explosion.Origin).GetSafeNormal();
+			FHitResult VictimHit(Victim, Victim->GetCapsuleComponent(), PendingVictim.ClosestPoint, ShotDirection);
+
+			// Falloff is already in Damage, a radial event would make AActor::TakeDamage scale it a second time
+			FPointDamageEvent DamageEvent(Damage, VictimHit, ShotDirection, Explosion.DamageTypeClass);
+
+			INC_DWORD_STAT(STAT_AreaDamageVictims);
+
+			Victim->TakeDamage(Damage, DamageEvent, Explosion.InstigatedBy.Get(), Explosion.DamageCauser.Get());
+		}
+	}
+
+	PendingExplosions.RemoveAt(0, Resolved, false);
+}
+
+#if !UE_BUILD_SHIPPING
+
+static FAutoConsoleCommandWithWorldAndArgs BenchAreaDamageCommand(
+	TEXT("survival.BenchAreaDamage"),
+	TEXT("Detonates N explosions (default 50) around the characters on the server without damaging anyone. Watch stat SurvivalGame for the query and resolve cost."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World) {
+
+		ASurvivalGameStateBase* GameState = World ? World->GetGameState<ASurvivalGameStateBase>() : nullptr;
+
+		if (GameState == nullptr || !GameState->HasAuthority()) {
+
+			UE_LOG(LogTemp, Warning, TEXT("survival.BenchAreaDamage runs on a server only."));
+			return;
+		}
+
+		const int32 Count = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 50;
+
+		TArray<FVector> Centers;
+		for (ASurvivalCharacter* Character : TActorRange<ASurvivalCharacter>(World)) {
+
+			Centers.Add(Character->GetActorLocation());
+		}
+
+		if (Centers.Num() == 0) {
+
+			Centers.Add(FVector::ZeroVector);
+		}
+
+		const FRadialDamageParams Params(100.f, 10.f, 200.f, 800.f, 1.f);
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		for (int32 i = 0; i < Count; ++i) {
+
+			const FVector Origin = Centers[i % Centers.Num()] + FMath::VRand() * FMath::FRandRange(0.f, Params.OuterRadius);
+			GameState->GetAreaDamage()->ApplyAreaDamage(Origin, Params, nullptr, nullptr, nullptr, true);
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("Queued %d explosions around %d characters in %.3f ms, damage resolves next frame."), Count, Centers.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	})
+);
+
+#endif
@@ -0,0 +1,310 @@
+// All rights reserved Dominik Pavlicek
+
+#include "CoreMinimal.h"
+
+#if !UE_BUILD_SHIPPING
+
+#include "Engine/ActorChannel.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Net/DataBunch.h"
+
+#include "Components/InventoryComponent.h"
+#include "Items/AmmoItem.h"
+#include "Items/FoodItem.h"
+#include "Items/GearItem.h"
+#include "Items/WeaponItem.h"
+
+/**
+ * Micro benchmark for the inventory hot paths, run with survival.BenchInventory [Iterations].
+ * Every operation runs against 10, 100 and 1000 item inventories, once targeting a non-stackable item
+ * and once the stack of a stackable item, which sits at the end of the list like it does after looting.
+ * Writes ns/op and allocations/op to Saved/Profiling/InventoryBench so results can be diffed between commits.
+ * Allocations are counted through FMalloc, other threads allocating at the same time add a little noise.
+ */
+struct FInventoryBenchmark
+{
+	struct FResult
+	{
+		FString Operation;
+		FString Target;
+		int32 NumItems;
+		int32 Iterations;
+		double NsPerOp;
+		double AllocsPerOp;
+	};
+
+	// Accumulates the cost of the measured part, restoring the inventory between iterations happens outside Run
+	struct FMeasurement
+	{
+		uint64 Cycles = 0;
+		uint64 Allocs = 0;
+		int32 Ops = 0;
+
+		template<typename FunctorType>
+		FORCEINLINE void Run(const int32 NumOps, FunctorType&& Functor) {
+
+			const uint64 StartAllocs = FMalloc::TotalMallocCalls + FMalloc::TotalReallocCalls;
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+
+			Functor();
+
+			Cycles += FPlatformTime::Cycles64() - StartCycles;
+			Allocs += (FMalloc::TotalMallocCalls + FMalloc::TotalReallocCalls) - StartAllocs;
+			Ops += NumOps;
+		}
+	};
+
+	static constexpr int32 StackQuantity = 45;
+
+	UWorld* World = nullptr;
+	AActor* Owner = nullptr;
+	UInventoryComponent* Inventory = nullptr;
+	TArray<FResult> Results;
+
+	FInventoryBenchmark(UWorld* InWorld) : World(InWorld) {};
+
+	void Record(const TCHAR* Operation, const bool bStackable, const int32 NumItems, const FMeasurement& Measurement) {
+
+		FResult& Result = Results.AddDefaulted_GetRef();
+		Result.Operation = Operation;
+		Result.Target = bStackable ? TEXT("Stackable") : TEXT("NonStackable");
+		Result.NumItems = NumItems;
+		Result.Iterations = Measurement.Ops;
+		Result.NsPerOp = Measurement.Ops > 0 ? FPlatformTime::ToSeconds64(Measurement.Cycles) * 1.0e9 / Measurement.Ops : 0.0;
+		Result.AllocsPerOp = Measurement.Ops > 0 ? double(Measurement.Allocs) / Measurement.Ops : 0.0;
+	}
+
+	// Fills a fresh inventory with NumItems entries: weapons and gear, one food stack, and the ammo stack last
+	void Populate(const int32 NumItems) {
+
+		Cleanup();
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+
+		Owner = World->SpawnActor<AActor>(SpawnParams);
+		Inventory = NewObject<UInventoryComponent>(Owner);
+		Inventory->RegisterComponent();
+		Inventory->SetCapacity(NumItems + 1);
+		Inventory->SetWeightCapacity(BIG_NUMBER);
+
+		UWeaponItem* Weapon = NewObject<UWeaponItem>(GetTransientPackage());
+		UGearItem* Gear = NewObject<UGearItem>(GetTransientPackage());
+
+		for (int32 i = 0; i < NumItems - 2; ++i) {
+
+			Inventory->TryAddItem_Internal(i % 2 ? static_cast<UItem*>(Gear) : static_cast<UItem*>(Weapon));
+		}
+
+		Inventory->TryAddItem_Internal(NewObject<UFoodItem>(GetTransientPackage()));
+
+		UAmmoItem* Ammo = NewObject<UAmmoItem>(GetTransientPackage());
+		Ammo->SetQuantity(StackQuantity);
+		Inventory->TryAddItem_Internal(Ammo);
+	}
+
+	void Cleanup() {
+
+		if (Owner != nullptr) {
+
+			Owner->Destroy();
+		}
+
+		Owner = nullptr;
+		Inventory = nullptr;
+	}
+
+	UItem* GetTarget(const bool bStackable) const {
+
+		// The ammo stack is last, the last non-stackable sits right before the food stack
+		return Inventory->Items[Inventory->Items.Num() - (bStackable ? 1 : 3)];
+	}
+
+	void BenchTryAddItem(const int32 NumItems, const bool bStackable, const int32 Iterations) {
+
+		UItem* Template = bStackable ? static_cast<UItem*>(NewObject<UAmmoItem>(GetTransientPackage())) : static_cast<UItem*>(NewObject<UWeaponItem>(GetTransientPackage()));
+		UItem* Stack = GetTarget(true);
+
+		FMeasurement Measurement;
+		for (int32 i = 0; i < Iterations; ++i) {
+
+			Measurement.Run(1, [&]() { Inventory->TryAddItem_Internal(Template); });
+
+			if (bStackable) {
+
+				Stack->SetQuantity(StackQuantity);
+			}
+			else Inventory->Items.Pop(false)->MarkPendingKill();
+		}
+
+		Record(TEXT("TryAddItem_Internal"), bStackable, NumItems, Measurement);
+	}
+
+	void BenchConsumeItem(const int32 NumItems, const bool bStackable, const int32 Iterations) {
+
+		UItem* Target = GetTarget(bStackable);
+		const int32 TargetIndex = Inventory->Items.IndexOfByKey(Target);
+
+		FMeasurement Measurement;
+		for (int32 i = 0; i < Iterations; ++i) {
+
+			Measurement.Run(1, [&]() { Inventory->ConsumeItem(Target, 1); });
+
+			// A non-stackable item is removed completely, put it back where it was
+			if (!bStackable) {
+
+				Inventory->Items.Insert(Target, TargetIndex);
+			}
+
+			Target->SetQuantity(bStackable ? StackQuantity : 1);
+		}
+
+		Record(TEXT("ConsumeItem"), bStackable, NumItems, Measurement);
+	}
+
+	void BenchFindItemByClass(const int32 NumItems, const bool bStackable, const int32 Iterations) {
+
+		const TSubclassOf<UItem> TargetClass = GetTarget(bStackable)->GetClass();
+
+		UItem* Found = nullptr;
+
+		FMeasurement Measurement;
+		Measurement.Run(Iterations, [&]() {
+
+			for (int32 i = 0; i < Iterations; ++i) {
+
+				Found = Inventory->FindItemByClass(TargetClass);
+			}
+		});
+
+		check(Found != nullptr);
+		Record(TEXT("FindItemByClass"), bStackable, NumItems, Measurement);
+	}
+
+	void BenchGetCurrentWeight(const int32 NumItems, const bool bStackable, const int32 Iterations) {
+
+		float Weight = 0.f;
+
+		FMeasurement Measurement;
+		Measurement.Run(Iterations, [&]() {
+
+			for (int32 i = 0; i < Iterations; ++i) {
+
+				Weight += Inventory->GetCurrentWeight();
+			}
+		});
+
+		check(Weight >= 0.f);
+		Record(TEXT("GetCurrentWeight"), bStackable, NumItems, Measurement);
+	}
+
+	// Needs a connected client, the items are written into a bunch that is never sent
+	void BenchReplicateSubobjects(const int32 NumItems, const bool bStackable, const int32 Iterations) {
+
+		UNetDriver* NetDriver = World->GetNetDriver();
+		UNetConnection* Connection = (NetDriver && NetDriver->ClientConnections.Num() > 0) ? NetDriver->ClientConnections[0] : nullptr;
+
+		if (Connection == nullptr || Connection->PlayerController == nullptr) {
+
+			return;
+		}
+
+		UActorChannel* Channel = Cast<UActorChannel>(Connection->CreateChannelByName(NAME_Actor, EChannelCreateFlags::OpenedLocally));
+
+		if (Channel == nullptr) {
+
+			return;
+		}
+
+		// Owned by the connection so ShouldReplicateItemsTo lets the items through
+		Owner->SetOwner(Connection->PlayerController);
+		Channel->SetChannelActor(Owner);
+
+		UItem* Target = GetTarget(bStackable);
+
+		FMeasurement Measurement;
+		for (int32 i = 0; i < Iterations; ++i) {
+
+			// Dirty the target item like a quantity change would, the rest of the items are skipped by their keys
+			Inventory->ReplicatedItemsKey++;
+			Target->RepKey++;
+
+			FOutBunch Bunch(Channel, false);
+			FReplicationFlags RepFlags;
+
+			Measurement.Run(1, [&]() { Inventory->ReplicateSubobjects(Channel, &Bunch, &RepFlags); });
+		}
+
+		Channel->ConditionalCleanUp(true, EChannelCloseReason::Destroyed);
+		Owner->SetOwner(nullptr);
+
+		Record(TEXT("ReplicateSubobjects"), bStackable, NumItems, Measurement);
+	}
+
+	void Run(const int32 Iterations) {
+
+		const int32 Sizes[] = { 10, 100, 1000 };
+
+		for (const int32 NumItems : Sizes) {
+
+			for (const bool bStackable : { false, true }) {
+
+				Populate(NumItems);
+
+				BenchTryAddItem(NumItems, bStackable, Iterations);
+				BenchConsumeItem(NumItems, bStackable, Iterations);
+				BenchFindItemByClass(NumItems, bStackable, Iterations);
+				BenchGetCurrentWeight(NumItems, bStackable, Iterations);
+				BenchReplicateSubobjects(NumItems, bStackable, Iterations);
+			}
+		}
+
+		Cleanup();
+	}
+
+	FString ToCSV() const {
+
+		FString CSV = TEXT("Operation,Target,Items,Iterations,NsPerOp,AllocsPerOp\n");
+
+		for (const FResult& Result : Results) {
+
+			CSV += FString::Printf(TEXT("%s,%s,%d,%d,%.1f,%.2f\n"), *Result.Operation, *Result.Target, Result.NumItems, Result.Iterations, Result.NsPerOp, Result.AllocsPerOp);
+		}
+
+		return CSV;
+	}
+};
+
+static FAutoConsoleCommandWithWorldAndArgs BenchInventoryCommand(
+	TEXT("survival.BenchInventory"),
+	TEXT("Times the inventory hot paths on 10, 100 and 1000 item inventories and writes ns/op and allocations/op to Saved/Profiling/InventoryBench. survival.BenchInventory [Iterations=2000], ReplicateSubobjects needs a connected client."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World) {
+
+		if (World == nullptr || World->IsNetMode(NM_Client)) {
+
+			UE_LOG(LogTemp, Warning, TEXT("survival.BenchInventory needs authority, run it on a server or in standalone."));
+			return;
+		}
+
+		const int32 Iterations = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 2000;
+
+		FInventoryBenchmark Benchmark(World);
+		Benchmark.Run(Iterations);
+
+		const FString CSV = Benchmark.ToCSV();
+		const FString FileName = FPaths::ProfilingDir() / TEXT("InventoryBench") / FString::Printf(TEXT("InventoryBench-%s.csv"), *FDateTime::Now().ToString());
+
+		FFileHelper::SaveStringToFile(CSV, *FileName);
+
+		UE_LOG(LogTemp, Log, TEXT("Inventory benchmark written to %s\n%s"), *FileName, *CSV);
+	})
+);
+
+#endif
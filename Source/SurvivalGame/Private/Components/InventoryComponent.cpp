@@ -2,9 +2,18 @@
 
 #include "InventoryComponent.h"
 #include "Engine/ActorChannel.h"
+#include "Engine/NetConnection.h"
+#include "GameFramework/PlayerController.h"
 #include "Net/UnrealNetwork.h"
 #include "Item.h"
 
+#include "SurvivalGame.h"
+#include "Character/SurvivalCharacter.h"
+#include "GameFramework/SurvivalNetAccounting.h"
+
+DECLARE_CYCLE_STAT(TEXT("Inventory Try Add Item"), STAT_InventoryTryAddItem, STATGROUP_SurvivalGame);
+DECLARE_CYCLE_STAT(TEXT("Inventory Replicate Subobjects"), STAT_InventoryReplicateSubobjects, STATGROUP_SurvivalGame);
+
 #define LOCTEXT_NAMESPACE "Inventory"
 
 UInventoryComponent::UInventoryComponent()
@@ -31,6 +40,7 @@ FItemAddResult UInventoryComponent::TryAddItemFromClass(TSubclassOf<class UItem>
 	}
 
 	UItem* Item = NewObject<UItem>(GetOwner(), ItemClass);
+	INC_DWORD_STAT(STAT_GameplayObjectsCreated);
 
 	Item->SetQuantity(Quantity);
 	return TryAddItem_Internal(Item);
@@ -38,6 +48,8 @@ FItemAddResult UInventoryComponent::TryAddItemFromClass(TSubclassOf<class UItem>
 
 FItemAddResult UInventoryComponent::TryAddItem_Internal(class UItem* Item) {
 
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_InventoryTryAddItem);
+
 	if (GetOwner() && GetOwner()->HasAuthority()) {
 
 		const int32 AddAmount = Item->GetQuantity();
@@ -192,6 +204,9 @@ bool UInventoryComponent::RemoveItem(class UItem* Item) {
 
 		if (Item != nullptr) {
 
+			// Lootables are dormant, wake them to send the shorter item list
+			GetOwner()->FlushNetDormancy();
+
 			Items.RemoveSingle(Item);
 			OnItemRemoved.Broadcast(Item);
 
@@ -264,6 +279,14 @@ TArray<UItem*> UInventoryComponent::FindItemsByClass(TSubclassOf<UItem> ItemClas
 	return ItrItems;
 }
 
+TArray<UItem*> UInventoryComponent::GetReplicatedItems() const {
+
+	TArray<UItem*> ReplicatedItems = Items;
+	ReplicatedItems.RemoveAll([](const UItem* Item) { return Item == nullptr; });
+
+	return ReplicatedItems;
+}
+
 float UInventoryComponent::GetCurrentWeight() const {
 
 	float ItemWeight = 0.f;
@@ -297,6 +320,7 @@ UItem* UInventoryComponent::AddItem(class UItem* Item) {
 	if (GetOwner() != nullptr && GetOwner()->HasAuthority()) {
 
 		UItem* NewItem = NewObject<UItem>(GetOwner(), Item->GetClass());
+		INC_DWORD_STAT(STAT_GameplayObjectsCreated);
 			NewItem->Quantity = Item->Quantity;
 			NewItem->OwningInventory = this;
 			NewItem->AddedToInventory(this);
@@ -317,9 +341,10 @@ void UInventoryComponent::OnRep_Items() {
 
 	OnInventoryUpdated.Broadcast();
 
-	if (Items.Num()) {
+	// Entries stay NULL until their item is replicated to us, which other players' inventories never are
+	for (auto& Item : Items) {
 
-		for (auto& Item : Items) {
+		if (Item != nullptr) {
 
 			Item->World = GetWorld();
 		}
@@ -338,18 +363,34 @@ void UInventoryComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>&
 	DOREPLIFETIME(UInventoryComponent, Items);
 }
 
+bool UInventoryComponent::CallRemoteFunction(UFunction* Function, void* Parameters, struct FOutParmRec* OutParms, FFrame* Stack) {
+
+	FSurvivalNetAccounting::FScopedRemoteFunction ScopedAccounting(GetOwner(), Function);
+
+	return Super::CallRemoteFunction(Function, Parameters, OutParms, Stack);
+}
+
 bool UInventoryComponent::ReplicateSubobjects(class UActorChannel *Channel, class FOutBunch *Bunch, FReplicationFlags *RepFlags) {
 
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_InventoryReplicateSubobjects);
+
 	bool bWroteSomething = Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
 
+	// Checked before the keys, they would otherwise be marked as sent and the items skipped once this connection may see them
+	if (!ShouldReplicateItemsTo(Channel->Connection)) {
+
+		return bWroteSomething;
+	}
+
 	// Check if the array need to replicate
 	if(Channel->KeyNeedsToReplicate(0, ReplicatedItemsKey)) {
 
 		for (auto Item : Items) {
 
-			if (Channel->KeyNeedsToReplicate(Item->GetUniqueID(), Item->RepKey)) {
+			if (Item != nullptr && Channel->KeyNeedsToReplicate(Item->GetUniqueID(), Item->RepKey)) {
 
-				bWroteSomething = Channel->ReplicateSubobject(Item, *Bunch, *RepFlags);
+				FSurvivalNetAccounting::FScopedSubobjectReplication ScopedAccounting(Item, Channel, Bunch);
+				bWroteSomething |= Channel->ReplicateSubobject(Item, *Bunch, *RepFlags);
 			}
 		}
 	}
@@ -357,16 +398,34 @@ bool UInventoryComponent::ReplicateSubobjects(class UActorChannel *Channel, clas
 	return bWroteSomething;
 }
 
+bool UInventoryComponent::ShouldReplicateItemsTo(const class UNetConnection* Connection) const {
+
+	const AActor* Owner = GetOwner();
+
+	if (Connection == nullptr || Owner == nullptr) {
+
+		return false;
+	}
+
+	if (Owner->GetNetConnection() == Connection) {
+
+		return true;
+	}
+
+	const APlayerController* PlayerController = Connection->PlayerController;
+	const ASurvivalCharacter* Viewer = PlayerController ? Cast<ASurvivalCharacter>(PlayerController->GetPawn()) : nullptr;
+
+	return Viewer != nullptr && Viewer->GetLootSource() == this;
+}
+
 void UInventoryComponent::ItemAdded(class UItem* Item)
 {
-	FString RoleString = GetOwner()->HasAuthority() ? "server" : "client";
-	UE_LOG(LogTemp, Warning, TEXT("Item added: %s on %s"), *GetNameSafe(Item), *RoleString);
+	UE_LOG(LogSurvivalInventory, Verbose, TEXT("Item added: %s on %s"), *GetNameSafe(Item), GetOwner()->HasAuthority() ? TEXT("server") : TEXT("client"));
 }
 
 void UInventoryComponent::ItemRemoved(class UItem* Item)
 {
-	FString RoleString = GetOwner()->HasAuthority() ? "server" : "client";
-	UE_LOG(LogTemp, Warning, TEXT("Item Removed: %s on %s"), *GetNameSafe(Item), *RoleString);
+	UE_LOG(LogSurvivalInventory, Verbose, TEXT("Item Removed: %s on %s"), *GetNameSafe(Item), GetOwner()->HasAuthority() ? TEXT("server") : TEXT("client"));
 }
 
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
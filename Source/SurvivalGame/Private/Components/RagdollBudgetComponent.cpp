@@ -0,0 +1,139 @@
+// All rights reserved Dominik Pavlicek
+
+
+#include "RagdollBudgetComponent.h"
+#include "Engine/World.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "HAL/IConsoleManager.h"
+
+#include "SurvivalGame.h"
+
+static TAutoConsoleVariable<int32> CVarMaxActiveRagdolls(
+	TEXT("survival.MaxActiveRagdolls"),
+	16,
+	TEXT("Number of dead bodies simulating physics at once, older ones are frozen in their pose.\n")
+	TEXT("Set per platform in the [SystemSettings] section of the platform Engine.ini."),
+	ECVF_Scalability);
+
+DECLARE_CYCLE_STAT(TEXT("Ragdoll Budget"), STAT_RagdollBudget, STATGROUP_SurvivalGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active Ragdolls"), STAT_ActiveRagdolls, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Frozen Ragdolls"), STAT_FrozenRagdolls, STATGROUP_SurvivalGame);
+
+URagdollBudgetComponent::URagdollBudgetComponent() {
+
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	// Resting checks do not need every frame
+	PrimaryComponentTick.TickInterval = 0.25f;
+
+	SettleSpeed = 10.f;
+	SettleTime = 1.f;
+	MinSimulationTime = 2.f;
+}
+
+void URagdollBudgetComponent::RegisterRagdoll(USkeletalMeshComponent* Mesh) {
+
+	if (Mesh == nullptr) {
+
+		return;
+	}
+
+	FActiveRagdoll& Ragdoll = ActiveRagdolls.AddDefaulted_GetRef();
+		Ragdoll.Mesh = Mesh;
+		Ragdoll.StartTime = GetWorld()->GetTimeSeconds();
+		Ragdoll.RestingSince = -1.f;
+
+	SET_DWORD_STAT(STAT_ActiveRagdolls, ActiveRagdolls.Num());
+
+	EnforceBudget();
+
+	SetComponentTickEnabled(ActiveRagdolls.Num() > 0);
+}
+
+void URagdollBudgetComponent::FreezeRagdoll(USkeletalMeshComponent* Mesh) {
+
+	if (Mesh == nullptr || !Mesh->IsSimulatingPhysics()) {
+
+		return;
+	}
+
+	INC_DWORD_STAT(STAT_FrozenRagdolls);
+
+	// Bone transforms stay where physics left them as long as nothing updates the skeleton again
+	Mesh->bNoSkeletonUpdate = true;
+	Mesh->SetComponentTickEnabled(false);
+	Mesh->SetSimulatePhysics(false);
+
+	// Still traceable for looting, no longer part of the physics scene
+	Mesh->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+}
+
+void URagdollBudgetComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) {
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	EnforceBudget();
+
+	if (ActiveRagdolls.Num() == 0) {
+
+		SetComponentTickEnabled(false);
+	}
+}
+
+void URagdollBudgetComponent::EnforceBudget() {
+
+	SCOPE_CYCLE_COUNTER(STAT_RagdollBudget);
+
+	const float Now = GetWorld()->GetTimeSeconds();
+	const float SettleSpeedSquared = FMath::Square(SettleSpeed);
+
+	ActiveRagdolls.RemoveAll([&](FActiveRagdoll& Ragdoll) {
+
+		USkeletalMeshComponent* Mesh = Ragdoll.Mesh.Get();
+
+		if (Mesh == nullptr || !Mesh->IsSimulatingPhysics()) {
+
+			return true;
+		}
+
+		// A sleeping body is as settled as it gets
+		const bool bResting = !Mesh->IsAnyRigidBodyAwake() || Mesh->GetPhysicsLinearVelocity().SizeSquared() < SettleSpeedSquared;
+
+		if (!bResting) {
+
+			Ragdoll.RestingSince = -1.f;
+			return false;
+		}
+
+		if (Ragdoll.RestingSince < 0.f) {
+
+			Ragdoll.RestingSince = Now;
+		}
+
+		if (Now - Ragdoll.RestingSince >= SettleTime) {
+
+			FreezeRagdoll(Mesh);
+			return true;
+		}
+
+		return false;
+	});
+
+	const int32 MaxActiveRagdolls = FMath::Max(0, CVarMaxActiveRagdolls.GetValueOnGameThread());
+	int32 NumToFreeze = ActiveRagdolls.Num() - MaxActiveRagdolls;
+	int32 NumFrozen = 0;
+
+	for (; NumFrozen < NumToFreeze && NumFrozen < ActiveRagdolls.Num(); ++NumFrozen) {
+
+		if (Now - ActiveRagdolls[NumFrozen].StartTime < MinSimulationTime) {
+
+			break;
+		}
+
+		FreezeRagdoll(ActiveRagdolls[NumFrozen].Mesh.Get());
+	}
+
+	ActiveRagdolls.RemoveAt(0, NumFrozen, false);
+
+	SET_DWORD_STAT(STAT_ActiveRagdolls, ActiveRagdolls.Num());
+}
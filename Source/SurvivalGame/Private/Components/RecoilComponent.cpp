@@ -0,0 +1,132 @@
+// All rights reserved Dominik Pavlicek
+
+
+#include "RecoilComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Math/RandomStream.h"
+
+#include "SurvivalGame.h"
+
+DECLARE_CYCLE_STAT(TEXT("Recoil Tick"), STAT_RecoilTick, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Recoil Steps"), STAT_RecoilSteps, STATGROUP_SurvivalGame);
+
+URecoilComponent::URecoilComponent() {
+
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickGroup = TG_PrePhysics;
+
+	FixedTimeStep = 1.f / 120.f;
+	MaxStepsPerFrame = 30;
+
+	BumpAmount = FVector2D::ZeroVector;
+	ResetAmount = FVector2D::ZeroVector;
+	RecoilSpeed = 0.f;
+	ResetSpeed = 0.f;
+	TimeAccumulator = 0.f;
+}
+
+FVector2D URecoilComponent::SampleRecoil(const TArray<FVector2D>& RecoilTable, const int32 Seed) {
+
+	if (RecoilTable.Num() == 0) {
+
+		return FVector2D::ZeroVector;
+	}
+
+	FRandomStream RandomStream(Seed);
+	const int32 YawIndex = RandomStream.RandHelper(RecoilTable.Num());
+	const int32 PitchIndex = RandomStream.RandHelper(RecoilTable.Num());
+
+	return FVector2D(RecoilTable[YawIndex].X, RecoilTable[PitchIndex].Y);
+}
+
+void URecoilComponent::AddRecoil(const FVector2D& Amount, const float InRecoilSpeed, const float InResetSpeed) {
+
+	BumpAmount += Amount;
+	ResetAmount -= Amount;
+
+	RecoilSpeed = InRecoilSpeed;
+	ResetSpeed = InResetSpeed;
+
+	if (!IsComponentTickEnabled()) {
+
+		TimeAccumulator = 0.f;
+		SetComponentTickEnabled(true);
+	}
+}
+
+void URecoilComponent::CompensateInput(const FVector2D& Input) {
+
+	// Only input against the pending recovery counts, aiming further away keeps the full recovery
+	if (ResetAmount.X > 0.f && Input.X > 0.f) {
+
+		ResetAmount.X = FMath::Max(0.f, ResetAmount.X - Input.X);
+	}
+	else if (ResetAmount.X < 0.f && Input.X < 0.f) {
+
+		ResetAmount.X = FMath::Min(0.f, ResetAmount.X - Input.X);
+	}
+
+	if (ResetAmount.Y > 0.f && Input.Y > 0.f) {
+
+		ResetAmount.Y = FMath::Max(0.f, ResetAmount.Y - Input.Y);
+	}
+	else if (ResetAmount.Y < 0.f && Input.Y < 0.f) {
+
+		ResetAmount.Y = FMath::Min(0.f, ResetAmount.Y - Input.Y);
+	}
+}
+
+void URecoilComponent::ResetRecoil() {
+
+	BumpAmount = FVector2D::ZeroVector;
+	ResetAmount = FVector2D::ZeroVector;
+	TimeAccumulator = 0.f;
+
+	SetComponentTickEnabled(false);
+}
+
+FVector2D URecoilComponent::Step(const float StepTime) {
+
+	const FVector2D OldBump = BumpAmount;
+	const FVector2D OldReset = ResetAmount;
+
+	BumpAmount.X = FMath::FInterpTo(BumpAmount.X, 0.f, StepTime, RecoilSpeed);
+	BumpAmount.Y = FMath::FInterpTo(BumpAmount.Y, 0.f, StepTime, RecoilSpeed);
+	ResetAmount.X = FMath::FInterpTo(ResetAmount.X, 0.f, StepTime, ResetSpeed);
+	ResetAmount.Y = FMath::FInterpTo(ResetAmount.Y, 0.f, StepTime, ResetSpeed);
+
+	return (OldBump - BumpAmount) + (OldReset - ResetAmount);
+}
+
+void URecoilComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) {
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	SCOPE_CYCLE_COUNTER(STAT_RecoilTick);
+
+	TimeAccumulator = FMath::Min(TimeAccumulator + DeltaTime, FixedTimeStep * MaxStepsPerFrame);
+
+	FVector2D CameraDelta = FVector2D::ZeroVector;
+	int32 NumSteps = 0;
+
+	for (; TimeAccumulator >= FixedTimeStep; TimeAccumulator -= FixedTimeStep, ++NumSteps) {
+
+		CameraDelta += Step(FixedTimeStep);
+	}
+
+	INC_DWORD_STAT_BY(STAT_RecoilSteps, NumSteps);
+
+	APlayerController* PC = Cast<APlayerController>(GetOwner());
+
+	if (PC != nullptr && !CameraDelta.IsZero()) {
+
+		PC->AddYawInput(CameraDelta.X);
+		PC->AddPitchInput(CameraDelta.Y);
+	}
+
+	if (!IsRecoiling()) {
+
+		ResetRecoil();
+	}
+}
@@ -0,0 +1,184 @@
+// All rights reserved Dominik Pavlicek
+
+
+#include "ThrowableSimulationComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "Components/StaticMeshComponent.h"
+
+#include "SurvivalGame.h"
+#include "Weapons/ThrowableWeapon.h"
+
+DECLARE_CYCLE_STAT(TEXT("Throwable Simulation"), STAT_ThrowableSimulation, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Throwable Simulation Steps"), STAT_ThrowableSimulationSteps, STATGROUP_SurvivalGame);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Simulated Throwables"), STAT_SimulatedThrowables, STATGROUP_SurvivalGame);
+
+UThrowableSimulationComponent::UThrowableSimulationComponent() {
+
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	// Before the actors that read throwable locations, eg. damage on detonation
+	PrimaryComponentTick.TickGroup = TG_PrePhysics;
+
+	FixedTimeStep = 1.f / 60.f;
+	MaxStepsPerFrame = 60;
+}
+
+float UThrowableSimulationComponent::GetServerTime() const {
+
+	const AGameStateBase* GameState = GetWorld()->GetGameState();
+	return GameState ? GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+}
+
+void UThrowableSimulationComponent::RegisterThrowable(AThrowableWeapon* Throwable) {
+
+	if (Throwable == nullptr || Simulations.ContainsByPredicate([Throwable](const FThrowableSimulationState& State) { return State.Throwable == Throwable; })) {
+
+		return;
+	}
+
+	const FThrowableLaunchData& LaunchData = Throwable->GetLaunchData();
+	const UProjectileMovementComponent* Movement = Throwable->GetThrowableMovement();
+	const UStaticMeshComponent* Mesh = Throwable->GetThrowableMesh();
+
+	FThrowableSimulationState State;
+		State.Throwable = Throwable;
+		State.Location = LaunchData.Origin;
+		State.PreviousLocation = LaunchData.Origin;
+		State.Velocity = LaunchData.Velocity;
+		State.SimulationTime = LaunchData.LaunchServerTime;
+		State.GravityZ = Movement->GetGravityZ();
+		State.Bounciness = Movement->Bounciness;
+		State.Friction = Movement->Friction;
+		State.StopSimulatingSpeed = Movement->BounceVelocityStopSimulatingThreshold;
+		State.bShouldBounce = Movement->bShouldBounce;
+		State.bRotationFollowsVelocity = Movement->bRotationFollowsVelocity;
+		State.bAtRest = false;
+		State.Shape = FCollisionShape::MakeSphere(Throwable->GetCollisionRadius());
+		State.CollisionChannel = Mesh->GetCollisionObjectType();
+		State.QueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(ThrowableSimulation), false, Throwable);
+		State.QueryParams.AddIgnoredActor(Throwable->Instigator);
+		State.ResponseParams = FCollisionResponseParams(Mesh->GetCollisionResponseToChannels());
+
+	Simulations.Add(State);
+	INC_DWORD_STAT(STAT_SimulatedThrowables);
+
+	SetComponentTickEnabled(true);
+}
+
+void UThrowableSimulationComponent::UnregisterThrowable(AThrowableWeapon* Throwable) {
+
+	const int32 Removed = Simulations.RemoveAllSwap([Throwable](const FThrowableSimulationState& State) { return State.Throwable == Throwable; });
+	DEC_DWORD_STAT_BY(STAT_SimulatedThrowables, Removed);
+
+	if (Simulations.Num() == 0) {
+
+		SetComponentTickEnabled(false);
+	}
+}
+
+void UThrowableSimulationComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) {
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	AdvanceTo(GetServerTime());
+}
+
+void UThrowableSimulationComponent::AdvanceTo(const float ServerTime) {
+
+	SCOPE_CYCLE_COUNTER(STAT_ThrowableSimulation);
+
+	UWorld* World = GetWorld();
+
+	for (int32 Index = Simulations.Num() - 1; Index >= 0; --Index) {
+
+		FThrowableSimulationState& State = Simulations[Index];
+		AThrowableWeapon* Throwable = State.Throwable.Get();
+
+		if (Throwable == nullptr) {
+
+			Simulations.RemoveAtSwap(Index);
+			DEC_DWORD_STAT(STAT_SimulatedThrowables);
+			continue;
+		}
+
+		if (State.bAtRest) {
+
+			continue;
+		}
+
+		int32 Steps = 0;
+		while (State.SimulationTime + FixedTimeStep <= ServerTime && Steps < MaxStepsPerFrame && !State.bAtRest) {
+
+			Step(State, World);
+			State.SimulationTime += FixedTimeStep;
+			++Steps;
+		}
+
+		INC_DWORD_STAT_BY(STAT_ThrowableSimulationSteps, Steps);
+
+		// Render between the last two steps, the fixed step rarely matches the frame time
+		const float Alpha = State.bAtRest ? 1.f : FMath::Clamp((ServerTime - State.SimulationTime) / FixedTimeStep, 0.f, 1.f);
+		const FVector RenderLocation = State.bAtRest ? State.Location : FMath::Lerp(State.PreviousLocation, State.Location, Alpha);
+
+		if (State.bRotationFollowsVelocity && !State.Velocity.IsNearlyZero()) {
+
+			Throwable->SetActorLocationAndRotation(RenderLocation, State.Velocity.Rotation());
+		}
+		else {
+
+			Throwable->SetActorLocation(RenderLocation);
+		}
+	}
+
+	if (Simulations.Num() == 0) {
+
+		SetComponentTickEnabled(false);
+	}
+}
+
+void UThrowableSimulationComponent::Step(FThrowableSimulationState& State, UWorld* World) const {
+
+	const float DeltaTime = FixedTimeStep;
+	const FVector Gravity(0.f, 0.f, State.GravityZ);
+
+	State.PreviousLocation = State.Location;
+
+	const FVector Delta = State.Velocity * DeltaTime + Gravity * (0.5f * DeltaTime * DeltaTime);
+	State.Velocity += Gravity * DeltaTime;
+
+	FHitResult Hit;
+	if (!World->SweepSingleByChannel(Hit, State.Location, State.Location + Delta, FQuat::Identity, State.CollisionChannel, State.Shape, State.QueryParams, State.ResponseParams)) {
+
+		State.Location += Delta;
+		return;
+	}
+
+	// Pull back from the surface a little, so the next sweep does not start in penetration
+	State.Location = Hit.Location + Hit.Normal * 0.1f;
+
+	if (!State.bShouldBounce) {
+
+		State.Velocity = FVector::ZeroVector;
+		State.bAtRest = true;
+		return;
+	}
+
+	const FVector Normal = Hit.Normal;
+	const float NormalSpeed = FVector::DotProduct(State.Velocity, Normal);
+
+	if (NormalSpeed < 0.f) {
+
+		const FVector NormalVelocity = Normal * NormalSpeed;
+		const FVector TangentVelocity = State.Velocity - NormalVelocity;
+
+		State.Velocity = TangentVelocity * (1.f - State.Friction) - NormalVelocity * State.Bounciness;
+	}
+
+	if (State.Velocity.SizeSquared() < FMath::Square(State.StopSimulatingSpeed)) {
+
+		State.Velocity = FVector::ZeroVector;
+		State.bAtRest = true;
+	}
+}
@@ -2,4 +2,80 @@
 
 
 #include "SurvivalGameInstance.h"
+#include "Engine/SkeletalMesh.h"
+#include "SkeletalMeshMerge.h"
 
+#include "SurvivalGame.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Merged Character Meshes"), STAT_MergedCharacterMeshes, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Merged Character Mesh Cache Hits"), STAT_MergedCharacterMeshCacheHits, STATGROUP_SurvivalGame);
+DECLARE_CYCLE_STAT(TEXT("Merge Character Mesh"), STAT_MergeCharacterMesh, STATGROUP_SurvivalGame);
+
+USurvivalGameInstance::USurvivalGameInstance() {
+
+	MaxMergedCharacterMeshes = 64;
+}
+
+USkeletalMesh* USurvivalGameInstance::GetMergedCharacterMesh(const TArray<USkeletalMesh*>& SourceMeshes, USkeleton* Skeleton) {
+
+	if (SourceMeshes.Num() == 0 || Skeleton == nullptr) {
+
+		return nullptr;
+	}
+
+	FString Key = Skeleton->GetPathName();
+	for (const USkeletalMesh* SourceMesh : SourceMeshes) {
+
+		Key += TEXT("|");
+		Key += SourceMesh ? SourceMesh->GetPathName() : FString();
+	}
+
+	// A failed merge is cached as null, the same meshes would fail again on every respawn
+	if (USkeletalMesh** CachedMesh = MergedCharacterMeshes.Find(Key)) {
+
+		INC_DWORD_STAT(STAT_MergedCharacterMeshCacheHits);
+
+		// Move the key to the back, there are few enough entries for a linear search
+		MergedCharacterMeshKeys.RemoveSingle(Key);
+		MergedCharacterMeshKeys.Add(Key);
+
+		return *CachedMesh;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_MergeCharacterMesh);
+
+	USkeletalMesh* MergedMesh = NewObject<USkeletalMesh>(this, NAME_None, RF_Transient);
+	MergedMesh->Skeleton = Skeleton;
+
+	TArray<FSkelMeshMergeSectionMapping> SectionMappings;
+	FSkeletalMeshMerge Merger(MergedMesh, SourceMeshes, SectionMappings, 0);
+
+	if (!Merger.DoMerge()) {
+
+		UE_LOG(LogTemp, Warning, TEXT("Merging %d character meshes failed, check that CPU access is enabled on them."), SourceMeshes.Num());
+		MergedMesh = nullptr;
+	}
+
+	// Characters still using an evicted mesh keep it alive, it is only dropped from the cache
+	while (MergedCharacterMeshKeys.Num() >= MaxMergedCharacterMeshes) {
+
+		USkeletalMesh* EvictedMesh = nullptr;
+		MergedCharacterMeshes.RemoveAndCopyValue(MergedCharacterMeshKeys[0], EvictedMesh);
+		MergedCharacterMeshKeys.RemoveAt(0, 1, false);
+
+		if (EvictedMesh != nullptr) {
+
+			DEC_DWORD_STAT(STAT_MergedCharacterMeshes);
+		}
+	}
+
+	MergedCharacterMeshes.Add(Key, MergedMesh);
+	MergedCharacterMeshKeys.Add(Key);
+
+	if (MergedMesh != nullptr) {
+
+		INC_DWORD_STAT(STAT_MergedCharacterMeshes);
+	}
+
+	return MergedMesh;
+}
@@ -3,3 +3,13 @@
 
 #include "SurvivalGameStateBase.h"
 
+#include "Components/ThrowableSimulationComponent.h"
+#include "Components/AreaDamageComponent.h"
+#include "Components/RagdollBudgetComponent.h"
+
+ASurvivalGameStateBase::ASurvivalGameStateBase() {
+
+	ThrowableSimulation = CreateDefaultSubobject<UThrowableSimulationComponent>(FName("ThrowableSimulation"));
+	AreaDamage = CreateDefaultSubobject<UAreaDamageComponent>(FName("AreaDamage"));
+	RagdollBudget = CreateDefaultSubobject<URagdollBudgetComponent>(FName("RagdollBudget"));
+}
@@ -0,0 +1,287 @@
+// All rights reserved Dominik Pavlicek
+
+
+#include "SurvivalNetAccounting.h"
+#include "Containers/Ticker.h"
+#include "Engine/ActorChannel.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Net/DataBunch.h"
+
+#include "SurvivalGame.h"
+
+// Counted where they are sent, so a new RPC needs no extra code as long as its class wraps CallRemoteFunction
+DECLARE_DWORD_COUNTER_STAT(TEXT("Server RPCs Sent"), STAT_ServerRPCs, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Client RPCs Sent"), STAT_ClientRPCs, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Multicast RPCs Sent"), STAT_MulticastRPCs, STATGROUP_SurvivalGame);
+
+static TAutoConsoleVariable<float> CVarNetAccounting(
+	TEXT("survival.NetAccounting"),
+	0.f,
+	TEXT("Records replicated bytes per connection, class, subobject and RPC and appends them to Saved/Profiling/NetAccounting every N seconds. 0 disables."),
+	ECVF_Default);
+
+static const FName NAME_Properties(TEXT("Properties"));
+static const FName NAME_ComponentsAndSubobjects(TEXT("ComponentsAndSubobjects"));
+static const FName NAME_Subobject(TEXT("Subobject"));
+
+struct FNetAccountingEntry
+{
+	int64 Bits = 0;
+	int32 Count = 0;
+};
+
+struct FNetAccountingConnection
+{
+	FString Name;
+	TMap<TPair<FName, FName>, FNetAccountingEntry> Entries;
+};
+
+struct FNetAccountingState
+{
+	TMap<TWeakObjectPtr<UNetConnection>, FNetAccountingConnection> Connections;
+
+	// Innermost actor being replicated, replication runs on the game thread only
+	FSurvivalNetAccounting::FScopedActorReplication* ActorScope = nullptr;
+
+	FString FileName;
+
+	double IntervalStart = 0.0;
+
+	bool bTickerRegistered = false;
+
+	static FNetAccountingState& Get() {
+
+		static FNetAccountingState State;
+		return State;
+	}
+
+	static FString GetConnectionName(const UNetConnection* Connection) {
+
+		const APlayerState* PlayerState = Connection->PlayerController ? Connection->PlayerController->PlayerState : nullptr;
+		const FString Address = Connection->LowLevelGetRemoteAddress(true);
+
+		return PlayerState ? FString::Printf(TEXT("%s (%s)"), *PlayerState->GetPlayerName(), *Address) : Address;
+	}
+
+	// Bytes already flushed plus what waits in the send buffer, only the difference over one call is meaningful
+	static int64 GetConnectionBits(const UNetConnection* Connection) {
+
+		return int64(Connection->OutBytes) * 8 + Connection->SendBuffer.GetNumBits();
+	}
+
+	bool Tick(float DeltaTime) {
+
+		const float Interval = CVarNetAccounting.GetValueOnGameThread();
+		const double Now = FPlatformTime::Seconds();
+
+		// Write out what is left when accounting gets disabled
+		if ((Interval > 0.f && Now - IntervalStart >= Interval) || (Interval <= 0.f && Connections.Num() > 0)) {
+
+			Dump(Now);
+		}
+
+		return true;
+	}
+
+	void Dump(const double Now) {
+
+		const double Elapsed = FMath::Max(Now - IntervalStart, 0.001);
+		IntervalStart = Now;
+
+		if (FileName.IsEmpty()) {
+
+			// ComponentsAndSubobjects rows exclude the Subobject rows, the rows of one connection add up to what it was sent
+			FileName = FPaths::ProfilingDir() / TEXT("NetAccounting") / FString::Printf(TEXT("NetAccounting-%s.csv"), *FDateTime::Now().ToString());
+			FFileHelper::SaveStringToFile(TEXT("Time,Connection,Class,Entry,Count,Bytes,BytesPerSecond\n"), *FileName);
+		}
+
+		const FString Time = FDateTime::Now().ToString();
+		FString CSV;
+
+		for (auto It = Connections.CreateIterator(); It; ++It) {
+
+			FNetAccountingConnection& Account = It.Value();
+
+			if (UNetConnection* Connection = It.Key().Get()) {
+
+				// The player state replicates in later than the first bytes are sent
+				Account.Name = GetConnectionName(Connection);
+			}
+
+			Account.Entries.ValueSort([](const FNetAccountingEntry& A, const FNetAccountingEntry& B) { return A.Bits > B.Bits; });
+
+			for (const auto& EntryPair : Account.Entries) {
+
+				const double Bytes = EntryPair.Value.Bits / 8.0;
+				CSV += FString::Printf(TEXT("%s,%s,%s,%s,%d,%.0f,%.1f\n"), *Time, *Account.Name.Replace(TEXT(","), TEXT(" ")), *EntryPair.Key.Key.ToString(), *EntryPair.Key.Value.ToString(), EntryPair.Value.Count, Bytes, Bytes / Elapsed);
+			}
+
+			// Closed connections are written one last time and dropped
+			if (!It.Key().IsValid()) {
+
+				It.RemoveCurrent();
+			}
+			else Account.Entries.Reset();
+		}
+
+		if (!CSV.IsEmpty()) {
+
+			FFileHelper::SaveStringToFile(CSV, *FileName, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+		}
+	}
+};
+
+bool FSurvivalNetAccounting::IsEnabled() {
+
+	return CVarNetAccounting.GetValueOnGameThread() > 0.f;
+}
+
+void FSurvivalNetAccounting::RecordBits(UNetConnection* Connection, const FName ClassName, const FName Entry, const int64 Bits) {
+
+	if (Connection == nullptr || Bits <= 0) {
+
+		return;
+	}
+
+	FNetAccountingState& State = FNetAccountingState::Get();
+
+	if (!State.bTickerRegistered) {
+
+		State.bTickerRegistered = true;
+		State.IntervalStart = FPlatformTime::Seconds();
+		FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(&State, &FNetAccountingState::Tick), 1.f);
+	}
+
+	FNetAccountingConnection& Account = State.Connections.FindOrAdd(Connection);
+
+	if (Account.Name.IsEmpty()) {
+
+		Account.Name = FNetAccountingState::GetConnectionName(Connection);
+	}
+
+	FNetAccountingEntry& AccountEntry = Account.Entries.FindOrAdd(TPair<FName, FName>(ClassName, Entry));
+	AccountEntry.Bits += Bits;
+	AccountEntry.Count++;
+}
+
+FSurvivalNetAccounting::FScopedActorReplication::FScopedActorReplication(const AActor* InActor, UActorChannel* InChannel, const FOutBunch* InBunch)
+	: Actor(InActor)
+	, Channel(nullptr)
+	, Bunch(InBunch)
+	, StartBits(0)
+	, SubobjectBits(0)
+	, OuterScope(nullptr)
+{
+	if (IsEnabled() && Actor != nullptr && InChannel != nullptr && Bunch != nullptr) {
+
+		Channel = InChannel;
+		StartBits = Bunch->GetNumBits();
+
+		FNetAccountingState& State = FNetAccountingState::Get();
+		OuterScope = State.ActorScope;
+		State.ActorScope = this;
+
+		// Includes the content block header of the actor, a few bytes
+		RecordBits(Channel->Connection, Actor->GetClass()->GetFName(), NAME_Properties, StartBits);
+	}
+}
+
+FSurvivalNetAccounting::FScopedActorReplication::~FScopedActorReplication() {
+
+	if (Channel != nullptr) {
+
+		FNetAccountingState::Get().ActorScope = OuterScope;
+
+		RecordBits(Channel->Connection, Actor->GetClass()->GetFName(), NAME_ComponentsAndSubobjects, Bunch->GetNumBits() - StartBits - SubobjectBits);
+	}
+}
+
+FSurvivalNetAccounting::FScopedSubobjectReplication::FScopedSubobjectReplication(const UObject* InSubobject, UActorChannel* InChannel, const FOutBunch* InBunch)
+	: Subobject(InSubobject)
+	, Channel(nullptr)
+	, Bunch(InBunch)
+	, StartBits(0)
+{
+	if (IsEnabled() && Subobject != nullptr && InChannel != nullptr && Bunch != nullptr) {
+
+		Channel = InChannel;
+		StartBits = Bunch->GetNumBits();
+	}
+}
+
+FSurvivalNetAccounting::FScopedSubobjectReplication::~FScopedSubobjectReplication() {
+
+	if (Channel != nullptr) {
+
+		const int64 Bits = Bunch->GetNumBits() - StartBits;
+		RecordBits(Channel->Connection, Subobject->GetClass()->GetFName(), NAME_Subobject, Bits);
+
+		// Written by a component of the actor in scope, take it out of that actor's ComponentsAndSubobjects
+		FScopedActorReplication* ActorScope = FNetAccountingState::Get().ActorScope;
+
+		if (ActorScope != nullptr && ActorScope->Bunch == Bunch) {
+
+			ActorScope->SubobjectBits += Bits;
+		}
+	}
+}
+
+FSurvivalNetAccounting::FScopedRemoteFunction::FScopedRemoteFunction(const AActor* InActor, const UFunction* InFunction)
+	: Actor(InActor)
+	, Function(InFunction)
+{
+	if (Function != nullptr) {
+
+		if (Function->HasAnyFunctionFlags(FUNC_NetServer)) {
+
+			INC_DWORD_STAT(STAT_ServerRPCs);
+		}
+		else if (Function->HasAnyFunctionFlags(FUNC_NetClient)) {
+
+			INC_DWORD_STAT(STAT_ClientRPCs);
+		}
+		else if (Function->HasAnyFunctionFlags(FUNC_NetMulticast)) {
+
+			INC_DWORD_STAT(STAT_MulticastRPCs);
+		}
+	}
+
+	UNetDriver* NetDriver = (IsEnabled() && Actor != nullptr) ? Actor->GetNetDriver() : nullptr;
+
+	if (NetDriver == nullptr) {
+
+		return;
+	}
+
+	// A multicast goes out on every connection, a client or server RPC only on one
+	if (NetDriver->ServerConnection != nullptr) {
+
+		StartBits.Emplace(NetDriver->ServerConnection, FNetAccountingState::GetConnectionBits(NetDriver->ServerConnection));
+	}
+
+	for (UNetConnection* Connection : NetDriver->ClientConnections) {
+
+		if (Connection != nullptr) {
+
+			StartBits.Emplace(Connection, FNetAccountingState::GetConnectionBits(Connection));
+		}
+	}
+}
+
+FSurvivalNetAccounting::FScopedRemoteFunction::~FScopedRemoteFunction() {
+
+	for (const TPair<UNetConnection*, int64>& Start : StartBits) {
+
+		RecordBits(Start.Key, Actor->GetClass()->GetFName(), Function->GetFName(), FNetAccountingState::GetConnectionBits(Start.Key) - Start.Value);
+	}
+}
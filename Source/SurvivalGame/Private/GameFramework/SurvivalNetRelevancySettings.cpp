@@ -0,0 +1,131 @@
+// All rights reserved Dominik Pavlicek
+
+
+#include "SurvivalNetRelevancySettings.h"
+#include "Engine/World.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetworkObjectList.h"
+#include "HAL/IConsoleManager.h"
+
+void USurvivalNetRelevancySettings::ApplyProfile(AActor* Actor) {
+
+	if (Actor == nullptr) {
+
+		return;
+	}
+
+	if (const FNetRelevancyProfile* Profile = GetDefault<USurvivalNetRelevancySettings>()->FindProfile(Actor->GetClass())) {
+
+		Actor->NetCullDistanceSquared = FMath::Square(Profile->NetCullDistance);
+		Actor->NetPriority = Profile->NetPriority;
+		Actor->NetUpdateFrequency = Profile->NetUpdateFrequency;
+		Actor->MinNetUpdateFrequency = FMath::Min(Profile->MinNetUpdateFrequency, Profile->NetUpdateFrequency);
+	}
+}
+
+const FNetRelevancyProfile* USurvivalNetRelevancySettings::FindProfile(const UClass* ActorClass) const {
+
+	const FNetRelevancyProfile* BestProfile = nullptr;
+	const UClass* BestClass = nullptr;
+
+	for (const FNetRelevancyProfile& Profile : Profiles) {
+
+		// A loaded actor has all its parent classes loaded, unloaded entries cannot match
+		const UClass* ProfileClass = Profile.ActorClass.Get();
+
+		if (ProfileClass != nullptr && ActorClass->IsChildOf(ProfileClass) && (BestClass == nullptr || ProfileClass->IsChildOf(BestClass))) {
+
+			BestProfile = &Profile;
+			BestClass = ProfileClass;
+		}
+	}
+
+	return BestProfile;
+}
+
+#if !UE_BUILD_SHIPPING
+
+struct FNetRelevancyClassReport
+{
+	int32 Actors = 0;
+	int32 Dormant = 0;
+	int32 OpenChannels = 0;
+	float UpdateRateSum = 0.f;
+	const FNetRelevancyProfile* Profile = nullptr;
+};
+
+static FAutoConsoleCommandWithWorld NetRelevancyReportCommand(
+	TEXT("survival.NetRelevancyReport"),
+	TEXT("Lists replicated actors per class with their relevancy profile, open channels and current adaptive update rate. Byte costs per class and connection come from survival.NetAccounting."),
+	FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World) {
+
+		UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+
+		if (NetDriver == nullptr || !NetDriver->IsServer()) {
+
+			UE_LOG(LogTemp, Warning, TEXT("survival.NetRelevancyReport runs on a server only."));
+			return;
+		}
+
+		const USurvivalNetRelevancySettings* Settings = GetDefault<USurvivalNetRelevancySettings>();
+		TMap<const UClass*, FNetRelevancyClassReport> Reports;
+
+		for (const TSharedPtr<FNetworkObjectInfo>& ObjectInfo : NetDriver->GetNetworkObjectList().GetAllObjects()) {
+
+			const AActor* Actor = ObjectInfo.IsValid() ? ObjectInfo->Actor : nullptr;
+
+			if (Actor == nullptr) {
+
+				continue;
+			}
+
+			FNetRelevancyClassReport& Report = Reports.FindOrAdd(Actor->GetClass());
+			Report.Profile = Settings->FindProfile(Actor->GetClass());
+			Report.Actors++;
+			Report.Dormant += (Actor->NetDormancy > DORM_Awake) ? 1 : 0;
+			Report.UpdateRateSum += (ObjectInfo->OptimalNetUpdateDelta > 0.f) ? 1.f / ObjectInfo->OptimalNetUpdateDelta : Actor->NetUpdateFrequency;
+		}
+
+		for (UNetConnection* Connection : NetDriver->ClientConnections) {
+
+			if (Connection == nullptr) {
+
+				continue;
+			}
+
+			for (const auto& ChannelPair : Connection->ActorChannelMap()) {
+
+				if (const AActor* Actor = ChannelPair.Key.Get()) {
+
+					if (FNetRelevancyClassReport* Report = Reports.Find(Actor->GetClass())) {
+
+						Report->OpenChannels++;
+					}
+				}
+			}
+		}
+
+		Reports.ValueSort([](const FNetRelevancyClassReport& A, const FNetRelevancyClassReport& B) { return A.OpenChannels > B.OpenChannels; });
+
+		UE_LOG(LogTemp, Log, TEXT("Net relevancy report, %d connections"), NetDriver->ClientConnections.Num());
+		UE_LOG(LogTemp, Log, TEXT("%-40s %8s %8s %9s %10s %10s %9s %9s"), TEXT("Class"), TEXT("Actors"), TEXT("Dormant"), TEXT("Channels"), TEXT("AvgRateHz"), TEXT("CullDist"), TEXT("Priority"), TEXT("Profile"));
+
+		for (const auto& ReportPair : Reports) {
+
+			const FNetRelevancyClassReport& Report = ReportPair.Value;
+
+			UE_LOG(LogTemp, Log, TEXT("%-40s %8d %8d %9d %10.1f %10.0f %9.2f %9s"),
+				*ReportPair.Key->GetName(),
+				Report.Actors,
+				Report.Dormant,
+				Report.OpenChannels,
+				Report.UpdateRateSum / Report.Actors,
+				Report.Profile ? Report.Profile->NetCullDistance : FMath::Sqrt(ReportPair.Key->GetDefaultObject<AActor>()->NetCullDistanceSquared),
+				Report.Profile ? Report.Profile->NetPriority : ReportPair.Key->GetDefaultObject<AActor>()->NetPriority,
+				Report.Profile ? TEXT("yes") : TEXT("no"));
+		}
+	})
+);
+
+#endif
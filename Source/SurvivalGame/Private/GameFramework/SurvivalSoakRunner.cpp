@@ -0,0 +1,398 @@
+// All rights reserved Dominik Pavlicek
+
+
+#include "SurvivalSoakRunner.h"
+#include "Engine/Engine.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/DamageType.h"
+#include "GameFramework/GameModeBase.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMemory.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+
+#include "Character/SurvivalCharacter.h"
+#include "Character/SurvivalSoakBotController.h"
+
+static uint64 GetAllocationCount() {
+
+#if !UE_BUILD_SHIPPING
+	return FMalloc::TotalMallocCalls + FMalloc::TotalReallocCalls;
+#else
+	return 0;
+#endif
+}
+
+ASurvivalSoakRunner::ASurvivalSoakRunner()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	DamageInterval = 0.25f;
+	DamagePerHit = 25.f;
+	RespawnDelay = 2.f;
+
+	NumBots = 0;
+	Duration = 0.f;
+	StartTime = 0.f;
+	NextDamageTime = 0.f;
+	bRunning = false;
+	bTickCostMode = false;
+
+	StartUsedPhysical = 0;
+	PeakUsedPhysical = 0;
+	StartAllocations = 0;
+	EndAllocations = 0;
+	StartInBytes = 0;
+	StartOutBytes = 0;
+	Respawns = 0;
+}
+
+void ASurvivalSoakRunner::StartSoak(const int32 InNumBots, const float InDuration, const int32 InSeed, const bool bInTickCostMode) {
+
+	NumBots = FMath::Max(InNumBots, 1);
+	bTickCostMode = bInTickCostMode;
+	Duration = FMath::Max(InDuration, 1.f);
+	Stream.Initialize(InSeed);
+
+	StartTime = GetWorld()->GetTimeSeconds();
+	NextDamageTime = StartTime + DamageInterval;
+
+	FrameTimes.Reset();
+	GameThreadTimes.Reset();
+	FrameTimes.Reserve(FMath::CeilToInt(Duration * 120.f));
+	GameThreadTimes.Reserve(FMath::CeilToInt(Duration * 120.f));
+
+	StartUsedPhysical = PeakUsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+
+	if (UNetDriver* NetDriver = GetWorld()->GetNetDriver()) {
+
+		StartInBytes = NetDriver->InTotalBytes;
+		StartOutBytes = NetDriver->OutTotalBytes;
+	}
+
+	Respawns = 0;
+
+	for (int32 i = 0; i < NumBots; ++i) {
+
+		SpawnBot(i);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Soak started with %d bots for %.0f s, seed %d%s."), NumBots, Duration, InSeed, bTickCostMode ? TEXT(", tick cost mode") : TEXT(""));
+
+	// Both land in Saved/Profiling, the stat file has every stat group including SurvivalGame
+	GEngine->Exec(GetWorld(), TEXT("stat startfile"));
+	GEngine->Exec(GetWorld(), TEXT("csvprofile start"));
+
+	StartAllocations = EndAllocations = GetAllocationCount();
+
+	bRunning = true;
+	SetActorTickEnabled(true);
+}
+
+void ASurvivalSoakRunner::SpawnBot(const int32 Index) {
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	ASurvivalSoakBotController* Bot = GetWorld()->SpawnActor<ASurvivalSoakBotController>(SpawnParams);
+
+	if (Bot == nullptr) {
+
+		return;
+	}
+
+	Bot->InitBot(Stream.RandHelper(MAX_int32));
+
+	// An idle bot leaves only the character's own per frame work
+	if (bTickCostMode) {
+
+		Bot->SetActorTickEnabled(false);
+	}
+	Bots.Add(Bot);
+	BotPawnLostTime.Add(0.f);
+
+	if (AGameModeBase* GameMode = GetWorld()->GetAuthGameMode()) {
+
+		GameMode->RestartPlayer(Bot);
+	}
+}
+
+void ASurvivalSoakRunner::Tick(float DeltaTime) {
+
+	Super::Tick(DeltaTime);
+
+	if (!bRunning) {
+
+		return;
+	}
+
+	FrameTimes.Add(FApp::GetDeltaTime() * 1000.f);
+	GameThreadTimes.Add(FPlatformTime::ToMilliseconds(GGameThreadTime));
+	PeakUsedPhysical = FMath::Max<uint64>(PeakUsedPhysical, FPlatformMemory::GetStats().UsedPhysical);
+
+	const float Now = GetWorld()->GetTimeSeconds();
+
+	if (!bTickCostMode && Now >= NextDamageTime) {
+
+		NextDamageTime = Now + DamageInterval;
+		ApplySoakDamage();
+	}
+
+	RespawnBots();
+
+	if (Now - StartTime >= Duration) {
+
+		FinishSoak();
+	}
+}
+
+void ASurvivalSoakRunner::ApplySoakDamage() {
+
+	if (Bots.Num() < 2) {
+
+		return;
+	}
+
+	auto GetLivingCharacter = [](const ASurvivalSoakBotController* Bot) -> ASurvivalCharacter* {
+
+		ASurvivalCharacter* Character = Bot ? Cast<ASurvivalCharacter>(Bot->GetPawn()) : nullptr;
+		return (Character != nullptr && Character->IsAlive()) ? Character : nullptr;
+	};
+
+	const int32 VictimIndex = Stream.RandHelper(Bots.Num());
+	ASurvivalCharacter* Victim = GetLivingCharacter(Bots[VictimIndex]);
+
+	if (Victim == nullptr) {
+
+		return;
+	}
+
+	// Only bots with a living character can be credited with the kill, the rest are waiting to respawn
+	TArray<ASurvivalSoakBotController*, TInlineAllocator<64>> Instigators;
+	for (int32 i = 0; i < Bots.Num(); ++i) {
+
+		if (i != VictimIndex && GetLivingCharacter(Bots[i]) != nullptr) {
+
+			Instigators.Add(Bots[i]);
+		}
+	}
+
+	if (Instigators.Num() > 0) {
+
+		ASurvivalSoakBotController* Instigator = Instigators[Stream.RandHelper(Instigators.Num())];
+		UGameplayStatics::ApplyDamage(Victim, DamagePerHit, Instigator, Instigator->GetPawn(), UDamageType::StaticClass());
+	}
+}
+
+void ASurvivalSoakRunner::RespawnBots() {
+
+	AGameModeBase* GameMode = GetWorld()->GetAuthGameMode();
+	const float Now = GetWorld()->GetTimeSeconds();
+
+	for (int32 i = 0; i < Bots.Num(); ++i) {
+
+		// The dead character turns into a corpse and unpossesses us, respawn a little later
+		if (Bots[i] == nullptr || Bots[i]->GetPawn() != nullptr) {
+
+			BotPawnLostTime[i] = 0.f;
+			continue;
+		}
+
+		if (BotPawnLostTime[i] == 0.f) {
+
+			BotPawnLostTime[i] = Now;
+		}
+		else if (GameMode != nullptr && Now - BotPawnLostTime[i] >= RespawnDelay) {
+
+			GameMode->RestartPlayer(Bots[i]);
+			BotPawnLostTime[i] = 0.f;
+			++Respawns;
+		}
+	}
+}
+
+void ASurvivalSoakRunner::FinishSoak() {
+
+	if (!bRunning) {
+
+		return;
+	}
+
+	bRunning = false;
+	SetActorTickEnabled(false);
+
+	StopCaptures();
+	LogReport();
+
+	for (ASurvivalSoakBotController* Bot : Bots) {
+
+		if (Bot != nullptr) {
+
+			if (APawn* BotPawn = Bot->GetPawn()) {
+
+				BotPawn->Destroy();
+			}
+
+			Bot->Destroy();
+		}
+	}
+
+	Bots.Reset();
+	BotPawnLostTime.Reset();
+
+	if (FParse::Param(FCommandLine::Get(), TEXT("SoakExit"))) {
+
+		FPlatformMisc::RequestExit(false);
+	}
+
+	Destroy();
+}
+
+void ASurvivalSoakRunner::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+
+	// Map change or PIE end, still write out what we have
+	if (bRunning && EndPlayReason != EEndPlayReason::Destroyed) {
+
+		bRunning = false;
+		StopCaptures();
+		LogReport();
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ASurvivalSoakRunner::StopCaptures() {
+
+	EndAllocations = GetAllocationCount();
+
+	GEngine->Exec(GetWorld(), TEXT("csvprofile stop"));
+	GEngine->Exec(GetWorld(), TEXT("stat stopfile"));
+}
+
+void ASurvivalSoakRunner::LogReport() const {
+
+	auto Summarize = [](const TArray<float>& Samples, float& OutAverage, float& OutP95, float& OutMax) {
+
+		OutAverage = OutP95 = OutMax = 0.f;
+
+		if (Samples.Num() == 0) {
+
+			return;
+		}
+
+		TArray<float> Sorted = Samples;
+		Sorted.Sort();
+
+		float Sum = 0.f;
+		for (const float Sample : Sorted) {
+
+			Sum += Sample;
+		}
+
+		OutAverage = Sum / Sorted.Num();
+		OutP95 = Sorted[FMath::Min(FMath::FloorToInt(Sorted.Num() * 0.95f), Sorted.Num() - 1)];
+		OutMax = Sorted.Last();
+	};
+
+	float FrameAvg, FrameP95, FrameMax;
+	Summarize(FrameTimes, FrameAvg, FrameP95, FrameMax);
+
+	float GameAvg, GameP95, GameMax;
+	Summarize(GameThreadTimes, GameAvg, GameP95, GameMax);
+
+	const uint64 EndUsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+
+	uint32 InBytes = 0;
+	uint32 OutBytes = 0;
+	int32 NumConnections = 0;
+
+	if (UNetDriver* NetDriver = GetWorld()->GetNetDriver()) {
+
+		InBytes = NetDriver->InTotalBytes - StartInBytes;
+		OutBytes = NetDriver->OutTotalBytes - StartOutBytes;
+		NumConnections = NetDriver->ClientConnections.Num();
+	}
+
+	int32 NumCharacters = 0;
+	int32 NumEnabledTicks = 0;
+
+	for (ASurvivalCharacter* Character : TActorRange<ASurvivalCharacter>(GetWorld())) {
+
+		++NumCharacters;
+
+		auto CountTick = [&NumEnabledTicks](const FTickFunction& TickFunction) {
+
+			NumEnabledTicks += (TickFunction.IsTickFunctionRegistered() && TickFunction.IsTickFunctionEnabled()) ? 1 : 0;
+		};
+
+		CountTick(Character->PrimaryActorTick);
+		CountTick(Character->CameraTickFunction);
+		CountTick(Character->InteractionTickFunction);
+		CountTick(Character->MeleeTickFunction);
+
+		for (const UActorComponent* Component : Character->GetComponents()) {
+
+			if (Component != nullptr) {
+
+				CountTick(Component->PrimaryComponentTick);
+			}
+		}
+	}
+
+	const float Elapsed = FMath::Max(GetWorld()->GetTimeSeconds() - StartTime, KINDA_SMALL_NUMBER);
+	const double ToMB = 1.0 / (1024.0 * 1024.0);
+
+	const uint64 Allocations = EndAllocations - StartAllocations;
+	const double AllocationsPerFrame = FrameTimes.Num() > 0 ? double(Allocations) / FrameTimes.Num() : 0.0;
+
+	UE_LOG(LogTemp, Log, TEXT("Soak report, %d bots, %.1f s, %d frames, %d respawns, %d characters at the end"), NumBots, Elapsed, FrameTimes.Num(), Respawns, NumCharacters);
+	UE_LOG(LogTemp, Log, TEXT("  Frame ms        avg %.2f  p95 %.2f  max %.2f"), FrameAvg, FrameP95, FrameMax);
+	UE_LOG(LogTemp, Log, TEXT("  Game thread ms  avg %.2f  p95 %.2f  max %.2f"), GameAvg, GameP95, GameMax);
+	UE_LOG(LogTemp, Log, TEXT("  Memory MB       start %.1f  end %.1f  peak %.1f"), StartUsedPhysical * ToMB, EndUsedPhysical * ToMB, PeakUsedPhysical * ToMB);
+	UE_LOG(LogTemp, Log, TEXT("  Allocations     total %llu  per frame %.1f (all threads)"), Allocations, AllocationsPerFrame);
+	UE_LOG(LogTemp, Log, TEXT("  Net KB/s        in %.2f  out %.2f  over %d connections"), InBytes / 1024.f / Elapsed, OutBytes / 1024.f / Elapsed, NumConnections);
+
+	if (bTickCostMode && NumCharacters > 0) {
+
+		UE_LOG(LogTemp, Log, TEXT("  Character ticks %.1f enabled tick functions and %.3f game thread ms per character"), float(NumEnabledTicks) / NumCharacters, GameAvg / NumCharacters);
+	}
+	UE_LOG(LogTemp, Log, TEXT("  Per subsystem timings are in the stat file and csv profile under Saved/Profiling"));
+}
+
+#if !UE_BUILD_SHIPPING
+
+static FAutoConsoleCommandWithWorldAndArgs SoakCommand(
+	TEXT("survival.Soak"),
+	TEXT("Runs a soak test on the server: survival.Soak [Bots=16] [Seconds=120] [Seed=1] [TickCost=0]. TickCost 1 keeps the bots idle and reports the tick cost per character. Pass -SoakExit on the command line to quit when it finishes."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World) {
+
+		if (World == nullptr || World->GetAuthGameMode() == nullptr) {
+
+			UE_LOG(LogTemp, Warning, TEXT("survival.Soak runs on a server only."));
+			return;
+		}
+
+		for (ASurvivalSoakRunner* Runner : TActorRange<ASurvivalSoakRunner>(World)) {
+
+			UE_LOG(LogTemp, Warning, TEXT("A soak is already running, finishing it early."));
+			Runner->FinishSoak();
+			return;
+		}
+
+		const int32 NumBots = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 16;
+		const float Duration = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 120.f;
+		const int32 Seed = Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 1;
+		const bool bTickCostMode = Args.Num() > 3 && FCString::Atoi(*Args[3]) != 0;
+
+		if (ASurvivalSoakRunner* Runner = World->SpawnActor<ASurvivalSoakRunner>()) {
+
+			Runner->StartSoak(NumBots, Duration, Seed, bTickCostMode);
+		}
+	})
+);
+
+#endif
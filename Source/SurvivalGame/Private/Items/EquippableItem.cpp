@@ -29,11 +29,9 @@ void UEquippableItem::Use(class ASurvivalCharacter* Character) {
 
 	if (Character != nullptr && Character->HasAuthority()) {
 
-		if (Character->GetEquippment().Contains(Slot) && !bIsEquiped) {
+		if (!bIsEquiped) {
 
-			UEquippableItem* AlreadyEquipped = *Character->GetEquippment().Find(Slot);
-
-			if (AlreadyEquipped != nullptr) {
+			if (UEquippableItem* AlreadyEquipped = Character->GetEquippedItem(Slot)) {
 
 				AlreadyEquipped->SetEquipped(false);
 			}
@@ -58,7 +56,7 @@ void UEquippableItem::AddedToInventory(class UInventoryComponent* Inventory) {
 		if (Player != nullptr && !Player->GetIsLooting()) {
 
 			// If Player does not have this slot occupied, then Equip
-			if (!(Player->GetEquippment().Contains(Slot))) {
+			if (Player->GetEquippedItem(Slot) == nullptr) {
 
 				SetEquipped(true);
 			}
@@ -97,7 +95,10 @@ void UEquippableItem::SetEquipped(bool NewEquipped) {
 
 void UEquippableItem::OnRep_EquipStatusChanged() {
 
-	if(ASurvivalCharacter* Character = Cast<ASurvivalCharacter>(GetOuter())) {
+	// Simulated proxies are dressed from the replicated equipment appearance of the character
+	ASurvivalCharacter* Character = Cast<ASurvivalCharacter>(GetOuter());
+
+	if (Character != nullptr && Character->Role != ROLE_SimulatedProxy) {
 
 		if (bIsEquiped) {
 
@@ -66,6 +66,12 @@ void UItem::MarkDirtyForReplication() {
 
 		++OwningInventory->ReplicatedItemsKey;
 	}
+
+	// Pickups and lootables sleep until their items change, wake the actor holding this item so the change gets sent
+	if (AActor* OwningActor = GetTypedOuter<AActor>()) {
+
+		OwningActor->FlushNetDormancy();
+	}
 }
 
 void UItem::OnRep_Quantity() {
@@ -2,8 +2,16 @@
 
 
 #include "ThrowableWeapon.h"
+#include "SurvivalGame.h"
 #include "Components/StaticMeshComponent.h"
 #include "GameFramework/ProjectileMovementComponent.h"
+#include "GameFramework/SurvivalNetRelevancySettings.h"
+#include "GameFramework/SurvivalGameStateBase.h"
+#include "Components/ThrowableSimulationComponent.h"
+#include "Components/AreaDamageComponent.h"
+#include "GameFramework/SurvivalNetAccounting.h"
+#include "Net/UnrealNetwork.h"
+#include "TimerManager.h"
 
 AThrowableWeapon::AThrowableWeapon()
 {
@@ -12,7 +20,124 @@ AThrowableWeapon::AThrowableWeapon()
 
 	ThrowableMovement = CreateDefaultSubobject<UProjectileMovementComponent>(FName("ThrowableMovementComp"));
 	ThrowableMovement->InitialSpeed = 1000.f;
+	ThrowableMovement->bShouldBounce = true;
+	ThrowableMovement->bAutoActivate = false;
+	ThrowableMovement->PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	FuseTime = 3.f;
+	CollisionRadius = 8.f;
+	ExplosionDamage = FRadialDamageParams(100.f, 10.f, 150.f, 600.f, 1.f);
+	bDetonated = false;
 
 	SetReplicates(true);
-	SetReplicateMovement(true);
-}
\ No newline at end of file
+	// Every machine simulates the flight from LaunchData
+	SetReplicateMovement(false);
+}
+
+void AThrowableWeapon::PostInitializeComponents() {
+
+	Super::PostInitializeComponents();
+
+	USurvivalNetRelevancySettings::ApplyProfile(this);
+}
+
+void AThrowableWeapon::BeginPlay() {
+
+	Super::BeginPlay();
+
+	if (HasAuthority()) {
+
+		const AGameStateBase* GameState = GetWorld()->GetGameState();
+
+		// The movement component already turned InitialSpeed into a world space velocity along our rotation
+		LaunchData.Origin = GetActorLocation();
+		LaunchData.Velocity = ThrowableMovement->Velocity;
+		LaunchData.LaunchServerTime = GameState ? GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+
+		StartSimulation();
+
+		GetWorldTimerManager().SetTimer(TimerHandle_Fuse, this, &AThrowableWeapon::Detonate, FuseTime, false);
+	}
+}
+
+void AThrowableWeapon::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+
+	if (ASurvivalGameStateBase* GameState = GetWorld()->GetGameState<ASurvivalGameStateBase>()) {
+
+		GameState->GetThrowableSimulation()->UnregisterThrowable(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AThrowableWeapon::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const {
+
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(AThrowableWeapon, LaunchData, COND_InitialOnly);
+}
+
+bool AThrowableWeapon::CallRemoteFunction(UFunction* Function, void* Parameters, struct FOutParmRec* OutParms, FFrame* Stack) {
+
+	FSurvivalNetAccounting::FScopedRemoteFunction ScopedAccounting(this, Function);
+
+	return Super::CallRemoteFunction(Function, Parameters, OutParms, Stack);
+}
+
+void AThrowableWeapon::OnRep_LaunchData() {
+
+	if (!bDetonated) {
+
+		StartSimulation();
+	}
+}
+
+void AThrowableWeapon::StartSimulation() {
+
+	if (ASurvivalGameStateBase* GameState = GetWorld()->GetGameState<ASurvivalGameStateBase>()) {
+
+		GameState->GetThrowableSimulation()->RegisterThrowable(this);
+	}
+	else {
+
+		SetActorLocation(LaunchData.Origin);
+		ThrowableMovement->Velocity = LaunchData.Velocity;
+		ThrowableMovement->Activate(true);
+	}
+}
+
+void AThrowableWeapon::Detonate() {
+
+	if (HasAuthority() && !bDetonated) {
+
+		MulticastDetonate(GetActorLocation());
+
+		ASurvivalGameStateBase* GameState = GetWorld()->GetGameState<ASurvivalGameStateBase>();
+
+		if (GameState && ExplosionDamage.BaseDamage > 0.f) {
+
+			GameState->GetAreaDamage()->ApplyAreaDamage(GetActorLocation(), ExplosionDamage, ExplosionDamageType, this, GetInstigatorController());
+		}
+
+		// Keep the channel open until the detonation reached everyone
+		SetLifeSpan(2.f);
+	}
+}
+
+void AThrowableWeapon::MulticastDetonate_Implementation(const FVector_NetQuantize& Location) {
+
+	bDetonated = true;
+
+	if (ASurvivalGameStateBase* GameState = GetWorld()->GetGameState<ASurvivalGameStateBase>()) {
+
+		GameState->GetThrowableSimulation()->UnregisterThrowable(this);
+	}
+
+	ThrowableMovement->Deactivate();
+
+	SetActorLocation(Location);
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+
+	OnDetonated(Location);
+}
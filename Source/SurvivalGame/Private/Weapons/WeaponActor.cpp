@@ -11,6 +11,8 @@
 #include "Components/AudioComponent.h"
 #include "Components/InventoryComponent.h"
 #include "Components/SkeletalMeshComponent.h"
+#include "Components/RecoilComponent.h"
+#include "GameFramework/SurvivalNetAccounting.h"
 
 #include "Curves/CurveVector.h"
 #include "Kismet/GameplayStatics.h"
@@ -18,9 +20,63 @@
 #include "Sound/SoundCue.h"
 #include "TimerManager.h"
 #include "DrawDebugHelpers.h"
+#include "HAL/IConsoleManager.h"
 
 #include "Net/UnrealNetwork.h"
 
+static TAutoConsoleVariable<int32> CVarLogFireRate(
+	TEXT("survival.LogFireRate"),
+	0,
+	TEXT("Logs the effective rounds per minute of every finished burst next to the configured rate.\n")
+	TEXT("Use together with t.MaxFPS to check the fire rate at low frame rates."),
+	ECVF_Cheat);
+
+static TAutoConsoleVariable<int32> CVarRecoilSeed(
+	TEXT("survival.RecoilSeed"),
+	0,
+	TEXT("When not 0, every burst uses this recoil seed instead of a random one.\n")
+	TEXT("Makes the camera path of a burst reproducible for benchmarks and recordings."),
+	ECVF_Cheat);
+
+/** Upper bound of automatic shots fired in one tick, so a long hitch can't empty the clip at once */
+static const int32 MaxShotsPerTick = 10;
+
+/** Time the shot after one due at ShotTime is due. Without catch-up it counts from the current tick, at most one shot per tick */
+static float GetNextShotTime(const float ShotTime, const float GameTime, const float TimeBetweenShots, const bool bCatchup)
+{
+	return (bCatchup ? ShotTime : GameTime) + TimeBetweenShots;
+}
+
+/**
+ * Calls FireShotAt(ShotTime) for every automatic shot due by GameTime, at most MaxShots.
+ * FireShotAt schedules the following shot in NextShotTime and returns false once the burst ended.
+ * Shots past the cap are dropped rather than carried into the following ticks.
+ */
+template<typename FunctorType>
+static void FireDueShots(float& NextShotTime, const float GameTime, const float TimeBetweenShots, const int32 MaxShots, FunctorType&& FireShotAt)
+{
+	bool bRefiring = true;
+	int32 ShotsFired = 0;
+
+	while (bRefiring && NextShotTime <= GameTime && ShotsFired < MaxShots)
+	{
+		bRefiring = FireShotAt(NextShotTime);
+		++ShotsFired;
+	}
+
+	if (bRefiring && NextShotTime <= GameTime)
+	{
+		NextShotTime = GameTime + TimeBetweenShots;
+	}
+}
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled Weapon FX Components"), STAT_WeaponFXPooled, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Weapon FX Reactivations"), STAT_WeaponFXReactivated, STATGROUP_SurvivalGame);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Weapon FX Pool Exhausted"), STAT_WeaponFXPoolExhausted, STATGROUP_SurvivalGame);
+DECLARE_CYCLE_STAT(TEXT("Weapon Handle Firing"), STAT_WeaponHandleFiring, STATGROUP_SurvivalGame);
+DECLARE_CYCLE_STAT(TEXT("Weapon Fire Shot"), STAT_WeaponFireShot, STATGROUP_SurvivalGame);
+DECLARE_CYCLE_STAT(TEXT("Weapon Server Handle Hit"), STAT_WeaponServerHandleHit, STATGROUP_SurvivalGame);
+
 AWeaponActor::AWeaponActor()
 {
 	WeaponMesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("WeaponMesh"));
@@ -43,14 +99,26 @@ AWeaponActor::AWeaponActor()
 	MuzzleAttachPoint = FName("Muzzle");
 
 	CurrentAmmoInClip = 0;
+	LocalShotSequence = 0;
 	BurstCounter = 0;
 	LastFireTime = 0.0f;
+	NextShotTime = 0.0f;
+	BurstShotCount = 0;
+	BurstStartTime = 0.0f;
+	RecoilBurstSeed = 0;
 
 	ADSTime = 0.5f;
 	RecoilResetSpeed = 5.f;
 	RecoilSpeed = 10.f;
+	RecoilTableSize = 64;
 
+	EffectsPoolSize = 4;
+	NextMuzzlePSCIndex = 0;
+	NextWeaponACIndex = 0;
+
+	// Only ticks while refiring
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 	PrimaryActorTick.TickGroup = TG_PrePhysics;
 	bReplicates = true;
 	bNetUseOwnerRelevancy = true;
@@ -61,10 +129,24 @@ void AWeaponActor::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLife
 
 	DOREPLIFETIME(AWeaponActor, PawnOwner);
 
-	DOREPLIFETIME_CONDITION(AWeaponActor, CurrentAmmoInClip, COND_OwnerOnly);
+	DOREPLIFETIME_CONDITION(AWeaponActor, AmmoAck, COND_OwnerOnly);
 	DOREPLIFETIME_CONDITION(AWeaponActor, BurstCounter, COND_SkipOwner);
 	DOREPLIFETIME_CONDITION(AWeaponActor, bPendingReload, COND_SkipOwner);
-	DOREPLIFETIME_CONDITION(AWeaponActor, Item, COND_InitialOnly);
+	DOREPLIFETIME(AWeaponActor, Item);
+}
+
+bool AWeaponActor::ReplicateSubobjects(class UActorChannel* Channel, class FOutBunch* Bunch, FReplicationFlags* RepFlags)
+{
+	FSurvivalNetAccounting::FScopedActorReplication ScopedAccounting(this, Channel, Bunch);
+
+	return Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
+}
+
+bool AWeaponActor::CallRemoteFunction(UFunction* Function, void* Parameters, struct FOutParmRec* OutParms, FFrame* Stack)
+{
+	FSurvivalNetAccounting::FScopedRemoteFunction ScopedAccounting(this, Function);
+
+	return Super::CallRemoteFunction(Function, Parameters, OutParms, Stack);
 }
 
 void AWeaponActor::PostInitializeComponents()
@@ -72,6 +154,41 @@ void AWeaponActor::PostInitializeComponents()
 	Super::PostInitializeComponents();
 
 	DetachMeshFromPawn();
+
+	// Only the firing player's machine applies recoil
+	if (GetNetMode() != NM_DedicatedServer)
+	{
+		BakeRecoilTable();
+	}
+}
+
+void AWeaponActor::BakeRecoilTable()
+{
+	RecoilTable.Reset();
+
+	if (RecoilCurve == nullptr)
+	{
+		return;
+	}
+
+	const int32 NumSamples = FMath::Max(RecoilTableSize, 2);
+	RecoilTable.Reserve(NumSamples);
+
+	for (int32 SampleIndex = 0; SampleIndex < NumSamples; ++SampleIndex)
+	{
+		const FVector Sample = RecoilCurve->GetVectorValue(static_cast<float>(SampleIndex) / (NumSamples - 1));
+		RecoilTable.Add(FVector2D(Sample.X, Sample.Y));
+	}
+}
+
+FVector2D AWeaponActor::GetShotRecoil(const int32 ShotIndex, const int32 Seed) const
+{
+	if (RecoilPattern.Num() > 0)
+	{
+		return RecoilPattern[FMath::Min(ShotIndex, RecoilPattern.Num() - 1)];
+	}
+
+	return URecoilComponent::SampleRecoil(RecoilTable, HashCombine(Seed, ShotIndex));
 }
 
 void AWeaponActor::BeginPlay()
@@ -82,6 +199,18 @@ void AWeaponActor::BeginPlay()
 	{
 		PawnOwner = Cast<ASurvivalCharacter>(GetOwner());
 	}
+
+	BindToOwnerInventory();
+}
+
+void AWeaponActor::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (bRefiring)
+	{
+		HandleReFiring();
+	}
 }
 
 void AWeaponActor::Destroyed()
@@ -91,11 +220,39 @@ void AWeaponActor::Destroyed()
 	StopSimulatingWeaponFire();
 }
 
+void AWeaponActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ReleaseEffectPools();
+
+	if (UInventoryComponent* Inventory = BoundInventory.Get())
+	{
+		Inventory->OnItemAdded.RemoveDynamic(this, &AWeaponActor::OnOwnerInventoryItemAdded);
+		Inventory->OnItemRemoved.RemoveDynamic(this, &AWeaponActor::OnOwnerInventoryItemRemoved);
+		Inventory->OnInventoryUpdated.RemoveDynamic(this, &AWeaponActor::OnOwnerInventoryUpdated);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void AWeaponActor::UseClipAmmo()
 {
 	if (HasAuthority())
 	{
 		--CurrentAmmoInClip;
+		UpdateAmmoAck();
+	}
+	else if (PawnOwner && PawnOwner->IsLocallyControlled())
+	{
+		// Predicted, corrected once the server acknowledges the shot
+		--CurrentAmmoInClip;
+	}
+}
+
+void AWeaponActor::UpdateAmmoAck()
+{
+	if (HasAuthority())
+	{
+		AmmoAck.AmmoInClip = CurrentAmmoInClip;
 	}
 }
 
@@ -105,7 +262,7 @@ void AWeaponActor::ConsumeAmmo(const int32 Amount)
 	{
 		if (UInventoryComponent* Inventory = PawnOwner->GetPlayerInventory())
 		{
-			if (UItem* AmmoItem = Inventory->FindItemByClass(WeaponConfig.AmmoClass))
+			if (UItem* AmmoItem = CachedAmmoItem.Get())
 			{
 				Inventory->ConsumeItem(AmmoItem, Amount);
 			}
@@ -125,6 +282,67 @@ void AWeaponActor::ReturnAmmoToInventory()
 				Inventory->TryAddItemFromClass(WeaponConfig.AmmoClass, CurrentAmmoInClip);
 			}
 		}
+
+		// The weapon actor is kept for the next equip, it must not keep the returned ammo
+		CurrentAmmoInClip = 0;
+		UpdateAmmoAck();
+	}
+}
+
+void AWeaponActor::BindToOwnerInventory()
+{
+	UInventoryComponent* Inventory = PawnOwner ? PawnOwner->GetPlayerInventory() : nullptr;
+
+	if (Inventory != BoundInventory.Get())
+	{
+		if (UInventoryComponent* OldInventory = BoundInventory.Get())
+		{
+			OldInventory->OnItemAdded.RemoveDynamic(this, &AWeaponActor::OnOwnerInventoryItemAdded);
+			OldInventory->OnItemRemoved.RemoveDynamic(this, &AWeaponActor::OnOwnerInventoryItemRemoved);
+			OldInventory->OnInventoryUpdated.RemoveDynamic(this, &AWeaponActor::OnOwnerInventoryUpdated);
+		}
+
+		// Item added/removed events fire on server only, clients refresh when the replicated item list changes
+		if (Inventory)
+		{
+			Inventory->OnItemAdded.AddUniqueDynamic(this, &AWeaponActor::OnOwnerInventoryItemAdded);
+			Inventory->OnItemRemoved.AddUniqueDynamic(this, &AWeaponActor::OnOwnerInventoryItemRemoved);
+			Inventory->OnInventoryUpdated.AddUniqueDynamic(this, &AWeaponActor::OnOwnerInventoryUpdated);
+		}
+
+		BoundInventory = Inventory;
+	}
+
+	RefreshCachedAmmo();
+}
+
+void AWeaponActor::RefreshCachedAmmo()
+{
+	UInventoryComponent* Inventory = BoundInventory.Get();
+	CachedAmmoItem = Inventory ? Inventory->FindItemByClass(WeaponConfig.AmmoClass) : nullptr;
+}
+
+void AWeaponActor::OnOwnerInventoryItemAdded(class UItem* AddedItem)
+{
+	if (AddedItem && AddedItem->GetClass() == WeaponConfig.AmmoClass)
+	{
+		CachedAmmoItem = AddedItem;
+	}
+}
+
+void AWeaponActor::OnOwnerInventoryItemRemoved(class UItem* RemovedItem)
+{
+	if (RemovedItem && RemovedItem == CachedAmmoItem.Get())
+	{
+		RefreshCachedAmmo();
+	}
+}
+
+void AWeaponActor::OnOwnerInventoryUpdated()
+{
+	if (!HasAuthority())
+	{
+		RefreshCachedAmmo();
 	}
 }
 
@@ -285,6 +503,12 @@ void AWeaponActor::StopReload()
 		DetermineWeaponState();
 		StopWeaponAnimation(ReloadAnim);
 	}
+	else if (bPendingReload)
+	{
+		// The reload never got to the reloading state, don't leave it pending forever
+		bPendingReload = false;
+		DetermineWeaponState();
+	}
 }
 
 void AWeaponActor::ReloadWeapon()
@@ -295,6 +519,7 @@ void AWeaponActor::ReloadWeapon()
 	{
 		CurrentAmmoInClip += ClipDelta;
 		ConsumeAmmo(ClipDelta);
+		UpdateAmmoAck();
 	}
 }
 
@@ -320,15 +545,9 @@ EWeaponState AWeaponActor::GetCurrentState() const
 
 int32 AWeaponActor::GetCurrentAmmo() const
 {
-	if (PawnOwner)
+	if (const UItem* Ammo = CachedAmmoItem.Get())
 	{
-		if (UInventoryComponent* Inventory = PawnOwner->GetPlayerInventory())
-		{
-			if (UItem* Ammo = Inventory->FindItemByClass(WeaponConfig.AmmoClass))
-			{
-				return Ammo->GetQuantity();
-			}
-		}
+		return Ammo->GetQuantity();
 	}
 
 	return 0;
@@ -362,6 +581,8 @@ void AWeaponActor::SetPawnOwner(ASurvivalCharacter* SurvivalCharacter)
 		PawnOwner = SurvivalCharacter;
 		// net owner for RPC calls
 		SetOwner(SurvivalCharacter);
+
+		BindToOwnerInventory();
 	}
 }
 
@@ -380,6 +601,18 @@ void AWeaponActor::ClientStartReload_Implementation()
 	StartReload();
 }
 
+void AWeaponActor::ClientStopReload_Implementation()
+{
+	GetWorldTimerManager().ClearTimer(TimerHandle_StopReload);
+
+	if (bPendingReload)
+	{
+		StopWeaponAnimation(ReloadAnim);
+		bPendingReload = false;
+		DetermineWeaponState();
+	}
+}
+
 void AWeaponActor::ServerStartFire_Implementation()
 {
 	StartFire();
@@ -402,6 +635,14 @@ bool AWeaponActor::ServerStopFire_Validate()
 
 void AWeaponActor::ServerStartReload_Implementation()
 {
+	// The client predicted a reload the server can't do, cancel it there instead of waiting for the animation
+	if (!CanReload())
+	{
+		ClientStopReload();
+		UpdateAmmoAck();
+		return;
+	}
+
 	StartReload();
 }
 
@@ -422,7 +663,7 @@ bool AWeaponActor::ServerStopReload_Validate()
 
 void AWeaponActor::OnRep_PawnOwner()
 {
-
+	BindToOwnerInventory();
 }
 
 void AWeaponActor::OnRep_BurstCounter()
@@ -437,6 +678,15 @@ void AWeaponActor::OnRep_BurstCounter()
 	}
 }
 
+void AWeaponActor::OnRep_AmmoAck()
+{
+	// Server state includes every shot up to ShotSequence, reapply the ones still in flight on top of it
+	const int32 AckedSequence = AmmoAck.ShotSequence;
+	PendingShotSequences.RemoveAll([AckedSequence](const int32 ShotSequence) { return ShotSequence <= AckedSequence; });
+
+	CurrentAmmoInClip = FMath::Max(0, AmmoAck.AmmoInClip - PendingShotSequences.Num());
+}
+
 void AWeaponActor::OnRep_Reload()
 {
 	if (bPendingReload)
@@ -460,21 +710,11 @@ void AWeaponActor::SimulateWeaponFire()
 	{
 		if (!bLoopedMuzzleFX || MuzzlePSC == nullptr)
 		{
-			// Split screen requires we create 2 effects. One that we see and one that the other player sees.
-			if ((PawnOwner != nullptr) && (PawnOwner->IsLocallyControlled() == true))
-			{
-				AController* PlayerCon = PawnOwner->GetController();
-				if (PlayerCon != nullptr)
-				{
-					WeaponMesh->GetSocketLocation(MuzzleAttachPoint);
-					MuzzlePSC = UGameplayStatics::SpawnEmitterAttached(MuzzleFX, WeaponMesh, MuzzleAttachPoint);
-					MuzzlePSC->bOwnerNoSee = false;
-					MuzzlePSC->bOnlyOwnerSee = true;
-				}
-			}
-			else
+			// Local player only gets the effect once it has a controller to view it through
+			const bool bLocallyControlled = (PawnOwner != nullptr) && (PawnOwner->IsLocallyControlled() == true);
+			if (!bLocallyControlled || PawnOwner->GetController() != nullptr)
 			{
-				MuzzlePSC = UGameplayStatics::SpawnEmitterAttached(MuzzleFX, WeaponMesh, MuzzleAttachPoint);
+				MuzzlePSC = ActivatePooledMuzzleFX();
 			}
 		}
 	}
@@ -496,7 +736,7 @@ void AWeaponActor::SimulateWeaponFire()
 	}
 	else
 	{
-		PlayWeaponSound(FireSound);
+		PlayPooledWeaponSound(FireSound);
 	}
 
 	ASurvivalPlayerController* PC = (PawnOwner != nullptr) ? Cast<ASurvivalPlayerController>(PawnOwner->Controller) : nullptr;
@@ -543,7 +783,7 @@ void AWeaponActor::StopSimulatingWeaponFire()
 		FireAC->FadeOut(0.1f, 0.0f);
 		FireAC = nullptr;
 
-		PlayWeaponSound(FireFinishSound);
+		PlayPooledWeaponSound(FireFinishSound);
 	}
 }
 
@@ -551,7 +791,7 @@ void AWeaponActor::HandleHit(const FHitResult& Hit, class ASurvivalCharacter* Hi
 {
 	if (Hit.GetActor())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Hit actor %s"), *Hit.GetActor()->GetName());
+		UE_LOG(LogSurvivalCombat, Verbose, TEXT("Hit actor %s"), *Hit.GetActor()->GetName());
 	}
 
 	ServerHandleHit(Hit, HitPlayer);
@@ -567,6 +807,8 @@ void AWeaponActor::HandleHit(const FHitResult& Hit, class ASurvivalCharacter* Hi
 
 void AWeaponActor::ServerHandleHit_Implementation(const FHitResult& Hit, class ASurvivalCharacter* HitPlayer /*= nullptr*/)
 {
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_WeaponServerHandleHit);
+
 	if (PawnOwner)
 	{
 		float DamageMultiplier = 1.f;
@@ -593,21 +835,36 @@ bool AWeaponActor::ServerHandleHit_Validate(const FHitResult& Hit, class ASurviv
 	return true;
 }
 
-void AWeaponActor::FireShot()
+void AWeaponActor::FireShot(float ShotTime)
 {
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_WeaponFireShot);
+
 	if (PawnOwner)
 	{
-		if (ASurvivalPlayerController* PC = Cast<ASurvivalPlayerController>(PawnOwner->GetController()))
+		// Any controller can fire, bots aim through their control rotation and have no recoil
+		if (AController* Controller = PawnOwner->GetController())
 		{
-			if (RecoilCurve)
+			ASurvivalPlayerController* PC = Cast<ASurvivalPlayerController>(Controller);
+
+			if (PC && (RecoilTable.Num() > 0 || RecoilPattern.Num() > 0))
 			{
-				const FVector2D RecoilAmount(RecoilCurve->GetVectorValue(FMath::RandRange(0.f, 1.f)).X, RecoilCurve->GetVectorValue(FMath::RandRange(0.f, 1.f)).Y);
-				//PC->ApplyRecoil(RecoilAmount, RecoilSpeed, RecoilResetSpeed, FireCameraShake);
+				if (BurstShotCount == 0)
+				{
+					const int32 FixedSeed = CVarRecoilSeed.GetValueOnGameThread();
+					RecoilBurstSeed = FixedSeed != 0 ? FixedSeed : FMath::Rand();
+				}
+
+				// Camera shake is already played by SimulateWeaponFire
+				PC->GetRecoil()->AddRecoil(GetShotRecoil(BurstShotCount, RecoilBurstSeed), RecoilSpeed, RecoilResetSpeed);
 			}
 
 			FVector CamLoc;
 			FRotator CamRot;
-			PC->GetPlayerViewPoint(CamLoc, CamRot);
+			Controller->GetPlayerViewPoint(CamLoc, CamRot);
+
+			// The view can't be rewound, so catch-up shots of one tick share its rotation.
+			// Their origin is moved back along the owner's velocity to where it was when the shot was due
+			CamLoc -= PawnOwner->GetVelocity() * FMath::Max(GetWorld()->GetTimeSeconds() - ShotTime, 0.f);
 
 			FHitResult Hit;
 			FCollisionQueryParams QueryParams;
@@ -635,20 +892,22 @@ void AWeaponActor::FireShot()
 
 void AWeaponActor::HandleReFiring()
 {
-	UWorld* MyWorld = GetWorld();
-
-	float SlackTimeThisFrame = FMath::Max(0.0f, (MyWorld->TimeSeconds - LastFireTime) - WeaponConfig.TimeBetweenShots);
+	const float GameTime = GetWorld()->GetTimeSeconds();
+	const int32 MaxShots = bAllowAutomaticWeaponCatchup ? MaxShotsPerTick : 1;
 
-	if (bAllowAutomaticWeaponCatchup)
+	// HandleFiring schedules the next shot, or clears bRefiring when the burst ends
+	FireDueShots(NextShotTime, GameTime, WeaponConfig.TimeBetweenShots, MaxShots, [this](const float ShotTime)
 	{
-		TimerIntervalAdjustment -= SlackTimeThisFrame;
-	}
-
-	HandleFiring();
+		HandleFiring(ShotTime);
+		return !!bRefiring;
+	});
 }
 
-void AWeaponActor::HandleFiring()
+void AWeaponActor::HandleFiring(float ShotTime)
 {
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_WeaponHandleFiring);
+
+	bool bFiredShot = false;
 
 	if ((CurrentAmmoInClip > 0) && CanFire())
 	{
@@ -659,12 +918,18 @@ void AWeaponActor::HandleFiring()
 
 		if (PawnOwner && PawnOwner->IsLocallyControlled())
 		{
-			FireShot();
+			FireShot(ShotTime);
 			UseClipAmmo();
+			bFiredShot = true;
 
 			// update firing FX on remote clients if function was called on server
 			BurstCounter++;
 		}
+
+		if (BurstShotCount++ == 0)
+		{
+			BurstStartTime = ShotTime;
+		}
 	}
 	else if (CanReload())
 	{
@@ -690,7 +955,13 @@ void AWeaponActor::HandleFiring()
 		// local client will notify server
 		if (Role < ROLE_Authority)
 		{
-			ServerHandleFiring();
+			const int32 ShotSequence = ++LocalShotSequence;
+			if (bFiredShot)
+			{
+				PendingShotSequences.Add(ShotSequence);
+			}
+
+			ServerHandleFiring(ShotSequence, GetWorld()->GetTimeSeconds() - ShotTime);
 		}
 
 		// reload after firing last round
@@ -699,30 +970,34 @@ void AWeaponActor::HandleFiring()
 			StartReload();
 		}
 
-		// setup refire timer
+		// schedule the next shot relative to when this one was due, not to when the tick happened
 		bRefiring = (CurrentState == EWeaponState::EWS_Firing && WeaponConfig.TimeBetweenShots > 0.0f);
 		if (bRefiring)
 		{
-			GetWorldTimerManager().SetTimer(TimerHandle_HandleFiring, this, &AWeaponActor::HandleReFiring, FMath::Max<float>(WeaponConfig.TimeBetweenShots + TimerIntervalAdjustment, SMALL_NUMBER), false);
-			TimerIntervalAdjustment = 0.f;
+			NextShotTime = GetNextShotTime(ShotTime, GetWorld()->GetTimeSeconds(), WeaponConfig.TimeBetweenShots, bAllowAutomaticWeaponCatchup);
 		}
+		SetActorTickEnabled(bRefiring);
 	}
 
-	LastFireTime = GetWorld()->GetTimeSeconds();
+	LastFireTime = ShotTime;
 }
 
 void AWeaponActor::OnBurstStarted()
 {
 	// start firing, can be delayed to satisfy TimeBetweenShots
 	const float GameTime = GetWorld()->GetTimeSeconds();
+	BurstShotCount = 0;
+
 	if (LastFireTime > 0 && WeaponConfig.TimeBetweenShots > 0.0f &&
 		LastFireTime + WeaponConfig.TimeBetweenShots > GameTime)
 	{
-		GetWorldTimerManager().SetTimer(TimerHandle_HandleFiring, this, &AWeaponActor::HandleFiring, LastFireTime + WeaponConfig.TimeBetweenShots - GameTime, false);
+		NextShotTime = LastFireTime + WeaponConfig.TimeBetweenShots;
+		bRefiring = true;
+		SetActorTickEnabled(true);
 	}
 	else
 	{
-		HandleFiring();
+		HandleFiring(GameTime);
 	}
 }
 
@@ -737,11 +1012,18 @@ void AWeaponActor::OnBurstFinished()
 		StopSimulatingWeaponFire();
 	}
 
-	GetWorldTimerManager().ClearTimer(TimerHandle_HandleFiring);
 	bRefiring = false;
+	SetActorTickEnabled(false);
+
+	if (CVarLogFireRate.GetValueOnGameThread() > 0 && BurstShotCount > 1 && WeaponConfig.TimeBetweenShots > 0.0f)
+	{
+		const float BurstDuration = LastFireTime - BurstStartTime;
+		const float EffectiveRPM = BurstDuration > 0.f ? (BurstShotCount - 1) * 60.f / BurstDuration : 0.f;
 
-	// reset firing interval adjustment
-	TimerIntervalAdjustment = 0.0f;
+		UE_LOG(LogTemp, Log, TEXT("%s burst: %d shots in %.3fs, %.1f RPM (configured %.1f RPM)"), *GetName(), BurstShotCount, BurstDuration, EffectiveRPM, 60.f / WeaponConfig.TimeBetweenShots);
+	}
+
+	BurstShotCount = 0;
 }
 
 void AWeaponActor::SetWeaponState(EWeaponState NewState)
@@ -801,13 +1083,20 @@ void AWeaponActor::AttachMeshToPawn() {
 		{
 			const FName AttachSocket = PawnOwner->IsLocallyControlled() ? AttachSocket1P : AttachSocket3P;
 			AttachToComponent(PawnOwner->GetMesh(), FAttachmentTransformRules::SnapToTargetNotIncludingScale, AttachSocket);
+
+			SetActorHiddenInGame(PawnOwner->bHidden);
+			WeaponMesh->SetComponentTickEnabled(true);
 		}
 	}
 }
 
 void AWeaponActor::DetachMeshFromPawn() {
 
-	// Currently not in use, because there is no switching weapons.
+	// Unequipped weapons are cached by their owner, so make them as cheap as possible until equipped again
+	DetachFromActor(FDetachmentTransformRules::KeepRelativeTransform);
+	SetActorHiddenInGame(true);
+	SetActorTickEnabled(false);
+	WeaponMesh->SetComponentTickEnabled(false);
 }
 
 UAudioComponent* AWeaponActor::PlayWeaponSound(USoundCue* Sound)
@@ -821,6 +1110,127 @@ UAudioComponent* AWeaponActor::PlayWeaponSound(USoundCue* Sound)
 	return AC;
 }
 
+UAudioComponent* AWeaponActor::PlayPooledWeaponSound(USoundCue* Sound)
+{
+	if (Sound == nullptr || PawnOwner == nullptr)
+	{
+		return nullptr;
+	}
+
+	UAudioComponent* AC = nullptr;
+	for (UAudioComponent* PooledAC : WeaponACPool)
+	{
+		if (PooledAC && !PooledAC->IsPlaying())
+		{
+			AC = PooledAC;
+			break;
+		}
+	}
+
+	if (AC == nullptr && WeaponACPool.Num() < EffectsPoolSize)
+	{
+		// Not auto destroyed, so the component stays around for the next shot
+		AC = UGameplayStatics::SpawnSoundAttached(Sound, WeaponMesh, NAME_None, FVector::ZeroVector, EAttachLocation::KeepRelativeOffset, false, 1.f, 1.f, 0.f, nullptr, nullptr, false);
+		if (AC)
+		{
+			WeaponACPool.Add(AC);
+			INC_DWORD_STAT(STAT_WeaponFXPooled);
+		}
+
+		return AC;
+	}
+
+	if (AC == nullptr && WeaponACPool.Num() > 0)
+	{
+		// Every pooled sound is still playing, cut off the oldest one
+		INC_DWORD_STAT(STAT_WeaponFXPoolExhausted);
+		NextWeaponACIndex %= WeaponACPool.Num();
+		AC = WeaponACPool[NextWeaponACIndex++];
+	}
+
+	if (AC)
+	{
+		INC_DWORD_STAT(STAT_WeaponFXReactivated);
+		AC->SetSound(Sound);
+		AC->Play();
+	}
+
+	return AC;
+}
+
+UParticleSystemComponent* AWeaponActor::ActivatePooledMuzzleFX()
+{
+	UParticleSystemComponent* PSC = nullptr;
+	for (UParticleSystemComponent* PooledPSC : MuzzlePSCPool)
+	{
+		if (PooledPSC && !PooledPSC->IsActive())
+		{
+			PSC = PooledPSC;
+			break;
+		}
+	}
+
+	if (PSC == nullptr && MuzzlePSCPool.Num() < EffectsPoolSize)
+	{
+		PSC = UGameplayStatics::SpawnEmitterAttached(MuzzleFX, WeaponMesh, MuzzleAttachPoint, FVector::ZeroVector, FRotator::ZeroRotator, EAttachLocation::KeepRelativeOffset, false);
+		if (PSC)
+		{
+			// Split screen requires we create 2 effects. One that we see and one that the other player sees.
+			if (PawnOwner && PawnOwner->IsLocallyControlled())
+			{
+				PSC->bOwnerNoSee = false;
+				PSC->bOnlyOwnerSee = true;
+			}
+
+			MuzzlePSCPool.Add(PSC);
+			INC_DWORD_STAT(STAT_WeaponFXPooled);
+		}
+
+		return PSC;
+	}
+
+	if (PSC == nullptr && MuzzlePSCPool.Num() > 0)
+	{
+		// Every pooled effect is still playing, restart the oldest one
+		INC_DWORD_STAT(STAT_WeaponFXPoolExhausted);
+		NextMuzzlePSCIndex %= MuzzlePSCPool.Num();
+		PSC = MuzzlePSCPool[NextMuzzlePSCIndex++];
+	}
+
+	if (PSC)
+	{
+		INC_DWORD_STAT(STAT_WeaponFXReactivated);
+		PSC->ActivateSystem(true);
+	}
+
+	return PSC;
+}
+
+void AWeaponActor::ReleaseEffectPools()
+{
+	DEC_DWORD_STAT_BY(STAT_WeaponFXPooled, MuzzlePSCPool.Num() + WeaponACPool.Num());
+
+	for (UParticleSystemComponent* PSC : MuzzlePSCPool)
+	{
+		if (PSC)
+		{
+			PSC->DestroyComponent();
+		}
+	}
+
+	for (UAudioComponent* AC : WeaponACPool)
+	{
+		if (AC)
+		{
+			AC->DestroyComponent();
+		}
+	}
+
+	MuzzlePSCPool.Empty();
+	WeaponACPool.Empty();
+	MuzzlePSC = nullptr;
+}
+
 float AWeaponActor::PlayWeaponAnimation(const FWeaponAnim& Animation)
 {
 	float Duration = 0.0f;
@@ -880,11 +1290,22 @@ FHitResult AWeaponActor::WeaponTrace(const FVector& StartTrace, const FVector& E
 	return Hit;
 }
 
-void AWeaponActor::ServerHandleFiring_Implementation()
+void AWeaponActor::ServerHandleFiring_Implementation(int32 ShotSequence, float ShotAge)
 {
+	// A stale or repeated shot is ignored, kicking the client for it would punish a hiccup rather than a cheat
+	if (ShotSequence <= AmmoAck.ShotSequence)
+	{
+		return;
+	}
+
 	const bool bShouldUpdateAmmo = (CurrentAmmoInClip > 0 && CanFire());
 
-	HandleFiring();
+	// Never further back than a capped catch-up could reach
+	const float MaxShotAge = WeaponConfig.TimeBetweenShots * MaxShotsPerTick;
+	HandleFiring(GetWorld()->GetTimeSeconds() - FMath::Clamp(ShotAge, 0.f, MaxShotAge));
+
+	// Acknowledge the shot even if it was rejected, so the client drops its prediction for it
+	AmmoAck.ShotSequence = ShotSequence;
 
 	if (bShouldUpdateAmmo)
 	{
@@ -894,9 +1315,88 @@ void AWeaponActor::ServerHandleFiring_Implementation()
 		// update firing FX on remote clients
 		BurstCounter++;
 	}
+	else
+	{
+		UpdateAmmoAck();
+	}
 }
 
-bool AWeaponActor::ServerHandleFiring_Validate()
+bool AWeaponActor::ServerHandleFiring_Validate(int32 ShotSequence, float ShotAge)
 {
 	return true;
-}
\ No newline at end of file
+}
+#if !UE_BUILD_SHIPPING
+
+static FAutoConsoleCommand TestFireRateCommand(
+	TEXT("survival.TestFireRate"),
+	TEXT("Runs the automatic fire scheduler on a fixed tick for a fixed time and logs an error when the effective RPM is off.\n")
+	TEXT("survival.TestFireRate [Seconds=10] [TickHz=30] [RPM...], the default rates don't divide the tick evenly."),
+	FConsoleCommandWithArgsDelegate::CreateStatic([](const TArray<FString>& Args)
+	{
+		const float Duration = Args.Num() > 0 ? FMath::Max(FCString::Atof(*Args[0]), 1.f) : 10.f;
+		const float TickRate = Args.Num() > 1 ? FMath::Max(FCString::Atof(*Args[1]), 1.f) : 30.f;
+
+		TArray<float> Rates;
+		for (int32 i = 2; i < Args.Num(); ++i)
+		{
+			Rates.Add(FMath::Max(FCString::Atof(*Args[i]), 1.f));
+		}
+
+		if (Rates.Num() == 0)
+		{
+			Rates = { 300.f, 600.f, 700.f, 857.f, 1100.f };
+		}
+
+		const int32 NumTicks = FMath::FloorToInt(Duration * TickRate);
+		int32 NumFailed = 0;
+
+		for (const float RPM : Rates)
+		{
+			const float TimeBetweenShots = 60.f / RPM;
+
+			// Same calls as HandleReFiring and HandleFiring with catch-up, the burst starts on the first tick
+			float NextShotTime = 0.f;
+			TArray<float> ShotTimes;
+
+			for (int32 Tick = 0; Tick <= NumTicks; ++Tick)
+			{
+				const float GameTime = Tick / TickRate;
+
+				FireDueShots(NextShotTime, GameTime, TimeBetweenShots, MaxShotsPerTick, [&](const float ShotTime)
+				{
+					ShotTimes.Add(ShotTime);
+					NextShotTime = GetNextShotTime(ShotTime, GameTime, TimeBetweenShots, true);
+					return true;
+				});
+			}
+
+			const int32 ExpectedShots = FMath::FloorToInt(NumTicks / TickRate / TimeBetweenShots) + 1;
+
+			float MaxSpacingError = 0.f;
+			for (int32 i = 1; i < ShotTimes.Num(); ++i)
+			{
+				MaxSpacingError = FMath::Max(MaxSpacingError, FMath::Abs(ShotTimes[i] - ShotTimes[i - 1] - TimeBetweenShots));
+			}
+
+			const float FiringTime = ShotTimes.Num() > 1 ? ShotTimes.Last() - ShotTimes[0] : 0.f;
+			const float EffectiveRPM = FiringTime > 0.f ? (ShotTimes.Num() - 1) * 60.f / FiringTime : 0.f;
+
+			// One shot of slack for a due time landing exactly on the last tick, a millisecond for float rounding
+			const bool bPassed = FMath::Abs(ShotTimes.Num() - ExpectedShots) <= 1 && MaxSpacingError < 0.001f && FMath::IsNearlyEqual(EffectiveRPM, RPM, RPM * 0.001f);
+
+			if (bPassed)
+			{
+				UE_LOG(LogTemp, Log, TEXT("Fire rate %.0f RPM at %.0f Hz: passed, %d shots (expected %d), %.2f RPM, spacing error %.3f ms"), RPM, TickRate, ShotTimes.Num(), ExpectedShots, EffectiveRPM, MaxSpacingError * 1000.f);
+			}
+			else
+			{
+				UE_LOG(LogTemp, Error, TEXT("Fire rate %.0f RPM at %.0f Hz: FAILED, %d shots (expected %d), %.2f RPM, spacing error %.3f ms"), RPM, TickRate, ShotTimes.Num(), ExpectedShots, EffectiveRPM, MaxSpacingError * 1000.f);
+				++NumFailed;
+			}
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("survival.TestFireRate: %d of %d rates failed over %.0f s."), NumFailed, Rates.Num(), Duration);
+	})
+);
+
+#endif
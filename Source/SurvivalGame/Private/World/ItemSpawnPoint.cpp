@@ -3,10 +3,13 @@
 
 #include "ItemSpawnPoint.h"
 
+#include "SurvivalGame.h"
 #include "World/Pickup.h"
 #include "Items/Item.h"
 #include "TimerManager.h"
 
+DECLARE_CYCLE_STAT(TEXT("Spawn Item"), STAT_SpawnItem, STATGROUP_SurvivalGame);
+
 AItemSpawnPoint::AItemSpawnPoint() {
 
 	PrimaryActorTick.bCanEverTick = false;
@@ -31,6 +34,8 @@ void AItemSpawnPoint::BeginPlay() {
 
 void AItemSpawnPoint::SpawnItem() {
 
+	SURVIVAL_SCOPE_CYCLE_COUNTER(STAT_SpawnItem);
+
 	if (HasAuthority() && LootTable != nullptr) {
 
 		TArray<FLootTableRow*> LootRows;
@@ -68,6 +73,7 @@ void AItemSpawnPoint::SpawnItem() {
 					SpawnTransform.AddToTranslation(LocationOffset);
 
 				APickup* NewPickupActor = GetWorld()->SpawnActor<APickup>(PickupClass, SpawnTransform, SpawnParams);
+					INC_DWORD_STAT(STAT_GameplayObjectsCreated);
 					NewPickupActor->InitializePickup(Itr, ItemQuantity);
 					NewPickupActor->OnDestroyed.AddDynamic(this, &AItemSpawnPoint::OnItemTaken);
 
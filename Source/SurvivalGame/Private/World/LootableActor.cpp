@@ -7,6 +7,7 @@
 #include "Components/StaticMeshComponent.h"
 #include "Components/InventoryComponent.h"
 #include "Components/InteractionComponent.h"
+#include "GameFramework/SurvivalNetRelevancySettings.h"
 
 #define LOCTEXT_NAMESPACE "Lootableactor"
 
@@ -27,6 +28,16 @@ ALootableActor::ALootableActor()
 	LootRolls = FIntPoint(2, 8);
 
 	SetReplicates(true);
+
+	// Woken up by inventory changes and looting only
+	NetDormancy = DORM_Initial;
+}
+
+void ALootableActor::PostInitializeComponents() {
+
+	Super::PostInitializeComponents();
+
+	USurvivalNetRelevancySettings::ApplyProfile(this);
 }
 
 void ALootableActor::BeginPlay()
@@ -4,11 +4,15 @@
 #include "Net/UnrealNetwork.h"
 #include "Engine/ActorChannel.h"
 
+#include "SurvivalGame.h"
+
 #include "Items/Item.h"
 #include "Character/SurvivalCharacter.h"
 #include "Components/StaticMeshComponent.h"
 #include "Components/InventoryComponent.h"
 #include "Components/InteractionComponent.h"
+#include "GameFramework/SurvivalNetRelevancySettings.h"
+#include "GameFramework/SurvivalNetAccounting.h"
 
 APickup::APickup() {
 
@@ -26,6 +30,16 @@ APickup::APickup() {
 		InteractionComponent->SetupAttachment(GetRootComponent());
 	
 	SetReplicates(true);
+
+	// Nothing changes on a pickup until it is taken, item changes flush the dormancy
+	NetDormancy = DORM_Initial;
+}
+
+void APickup::PostInitializeComponents() {
+
+	Super::PostInitializeComponents();
+
+	USurvivalNetRelevancySettings::ApplyProfile(this);
 }
 
 void APickup::BeginPlay()
@@ -55,6 +69,7 @@ void APickup::InitializePickup(const TSubclassOf<class UItem> ItemClass, const i
 	if (HasAuthority() && ItemClass && Quantity > 0) {
 
 		Item = NewObject<UItem>(this, ItemClass);
+		INC_DWORD_STAT(STAT_GameplayObjectsCreated);
 		Item->SetQuantity(Quantity);
 
 		if(Item->ItemPickupMesh) {
@@ -152,6 +167,7 @@ bool APickup::ReplicateSubobjects(class UActorChannel *Channel, class FOutBunch
 
 	if (Item != nullptr && Channel->KeyNeedsToReplicate(Item->GetUniqueID(), Item->RepKey)) {
 
+		FSurvivalNetAccounting::FScopedSubobjectReplication ScopedAccounting(Item, Channel, Bunch);
 		bWroteSomething |= Channel->ReplicateSubobject(Item, *Bunch, *RepFlags);
 	}
 
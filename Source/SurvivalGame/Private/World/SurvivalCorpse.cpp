@@ -0,0 +1,292 @@
+// All rights reserved Dominik Pavlicek
+
+
+#include "SurvivalCorpse.h"
+#include "Engine/World.h"
+#include "Engine/SkeletalMesh.h"
+#include "Components/BoxComponent.h"
+#include "Components/PoseableMeshComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Camera/CameraTypes.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "Engine/NetSerialization.h"
+#include "Net/UnrealNetwork.h"
+
+#include "SurvivalGame.h"
+#include "Character/SurvivalCharacter.h"
+#include "Components/InventoryComponent.h"
+#include "Components/InteractionComponent.h"
+#include "Items/Item.h"
+#include "GameFramework/SurvivalGameInstance.h"
+#include "GameFramework/SurvivalNetRelevancySettings.h"
+
+#define LOCTEXT_NAMESPACE "SurvivalCorpse"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Corpses"), STAT_Corpses, STATGROUP_SurvivalGame);
+
+bool FCorpsePose::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess) {
+
+	uint16 NumBones = BoneRotations.Num();
+	Ar << NumBones;
+
+	if (Ar.IsLoading()) {
+
+		BoneRotations.SetNumUninitialized(NumBones);
+	}
+
+	bOutSuccess = true;
+
+	for (FQuat& BoneRotation : BoneRotations) {
+
+		FRotator Rotator = Ar.IsSaving() ? BoneRotation.Rotator() : FRotator::ZeroRotator;
+		Rotator.SerializeCompressedShort(Ar);
+
+		if (Ar.IsLoading()) {
+
+			BoneRotation = Rotator.Quaternion();
+		}
+	}
+
+	bOutSuccess &= SerializePackedVector<10, 24>(RootTranslation, Ar);
+
+	return true;
+}
+
+ASurvivalCorpse::ASurvivalCorpse()
+{
+	// Only interaction traces need to hit a corpse
+	LootCollision = CreateDefaultSubobject<UBoxComponent>(FName("LootCollision"));
+		LootCollision->SetBoxExtent(FVector(90.f, 90.f, 30.f));
+		LootCollision->SetCollisionObjectType(ECC_WorldDynamic);
+		LootCollision->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+		LootCollision->SetCollisionResponseToAllChannels(ECR_Ignore);
+		LootCollision->SetCollisionResponseToChannel(ECC_Visibility, ECR_Block);
+	SetRootComponent(LootCollision);
+
+	CorpseMesh = CreateDefaultSubobject<UPoseableMeshComponent>(FName("CorpseMesh"));
+		CorpseMesh->SetupAttachment(GetRootComponent());
+		CorpseMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
+	InteractionComp = CreateDefaultSubobject<UInteractionComponent>(FName("InteractionComp"));
+		InteractionComp->SetInteractionActionText(LOCTEXT("LootPlayerText", "Loot"));
+		InteractionComp->SetInteractionNameText(LOCTEXT("LootPlayerName", "Player"));
+		InteractionComp->SetupAttachment(GetRootComponent());
+
+	InventoryComp = CreateDefaultSubobject<UInventoryComponent>(FName("InventoryComp"));
+
+	DeathCameraDistance = 500.f;
+	DeathCameraHeight = 250.f;
+
+	SetReplicates(true);
+
+	// Woken up by inventory changes and looting only
+	NetDormancy = DORM_Initial;
+}
+
+void ASurvivalCorpse::InitFromCharacter(ASurvivalCharacter* Character) {
+
+	check(HasAuthority());
+
+	SourceCharacter = Character;
+
+	USkeletalMeshComponent* BodyMesh = Character->GetMesh();
+	PoseMesh = BodyMesh->SkeletalMesh;
+	CapturePose(BodyMesh, Pose);
+
+	for (int32 SlotIndex = 0; SlotIndex < NumEquippableSlots; ++SlotIndex) {
+
+		USkeletalMeshComponent* SlotMesh = Character->GetSlotSkeletalMeshComponent(static_cast<EEquippableSlot>(SlotIndex));
+
+		if (SlotMesh != nullptr && SlotMesh->SkeletalMesh != nullptr) {
+
+			PartMeshes.AddUnique(SlotMesh->SkeletalMesh);
+		}
+	}
+
+	if (APlayerState* PS = Character->GetPlayerState()) {
+
+		PlayerName = PS->GetPlayerName();
+	}
+
+	// Unequipped gear went back into the inventory on death, so this holds everything the player carried
+	UInventoryComponent* CharacterInventory = Character->GetPlayerInventory();
+	InventoryComp->SetCapacity(CharacterInventory->GetCapacity());
+	InventoryComp->SetWeightCapacity(CharacterInventory->GetWeightCapacity());
+
+	for (UItem* Item : CharacterInventory->GetItems()) {
+
+		if (Item != nullptr) {
+
+			InventoryComp->TryAddItem(Item);
+		}
+	}
+}
+
+void ASurvivalCorpse::PostInitializeComponents() {
+
+	Super::PostInitializeComponents();
+
+	USurvivalNetRelevancySettings::ApplyProfile(this);
+}
+
+void ASurvivalCorpse::BeginPlay()
+{
+	Super::BeginPlay();
+
+	INC_DWORD_STAT(STAT_Corpses);
+
+	InteractionComp->OnInteract.AddDynamic(this, &ASurvivalCorpse::OnInteract);
+
+	if (!PlayerName.IsEmpty()) {
+
+		InteractionComp->SetInteractionNameText(FText::FromString(PlayerName));
+	}
+
+	OnRep_Appearance();
+
+	// The owner is the controller of the dead player, which only exists on their machine and the server
+	APlayerController* PC = Cast<APlayerController>(GetOwner());
+
+	if (PC != nullptr && PC->IsLocalController() && (PC->GetPawn() == nullptr || PC->GetPawn() == SourceCharacter)) {
+
+		PC->SetViewTarget(this);
+	}
+}
+
+void ASurvivalCorpse::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+
+	DEC_DWORD_STAT(STAT_Corpses);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ASurvivalCorpse::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const {
+
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(ASurvivalCorpse, PoseMesh, COND_InitialOnly);
+	DOREPLIFETIME_CONDITION(ASurvivalCorpse, PartMeshes, COND_InitialOnly);
+	DOREPLIFETIME_CONDITION(ASurvivalCorpse, Pose, COND_InitialOnly);
+	DOREPLIFETIME_CONDITION(ASurvivalCorpse, SourceCharacter, COND_InitialOnly);
+	DOREPLIFETIME_CONDITION(ASurvivalCorpse, PlayerName, COND_InitialOnly);
+}
+
+void ASurvivalCorpse::OnInteract(class ASurvivalCharacter* Character) {
+
+	if (Character != nullptr) {
+
+		Character->SetLootingSource(InventoryComp);
+	}
+}
+
+void ASurvivalCorpse::OnRep_Appearance() {
+
+	// Nobody looks at corpses on a dedicated server
+	if (GetNetMode() == NM_DedicatedServer || PoseMesh == nullptr || !HasActorBegunPlay()) {
+
+		return;
+	}
+
+	USkeletalMesh* VisibleMesh = PoseMesh;
+
+	if (PartMeshes.Num() > 1) {
+
+		if (USurvivalGameInstance* GameInstance = GetGameInstance<USurvivalGameInstance>()) {
+
+			if (USkeletalMesh* MergedMesh = GameInstance->GetMergedCharacterMesh(PartMeshes, PoseMesh->Skeleton)) {
+
+				VisibleMesh = MergedMesh;
+			}
+		}
+	}
+
+	if (CorpseMesh->SkeletalMesh != VisibleMesh) {
+
+		CorpseMesh->SetSkeletalMesh(VisibleMesh);
+	}
+
+	// Our own ragdoll ended up somewhere slightly different than the server's, keep what this player saw
+	if (SourceCharacter != nullptr && SourceCharacter->GetMesh()->SkeletalMesh == PoseMesh) {
+
+		FCorpsePose LocalPose;
+		CapturePose(SourceCharacter->GetMesh(), LocalPose);
+
+		CorpseMesh->SetWorldTransform(SourceCharacter->GetMesh()->GetComponentTransform());
+		ApplyPose(LocalPose);
+	}
+	else {
+
+		ApplyPose(Pose);
+	}
+}
+
+void ASurvivalCorpse::CapturePose(const USkeletalMeshComponent* Mesh, FCorpsePose& OutPose) {
+
+	const TArray<FTransform>& ComponentSpaceTransforms = Mesh->GetComponentSpaceTransforms();
+	const FReferenceSkeleton& RefSkeleton = Mesh->SkeletalMesh->RefSkeleton;
+
+	OutPose.BoneRotations.SetNumUninitialized(ComponentSpaceTransforms.Num());
+
+	for (int32 BoneIndex = 0; BoneIndex < ComponentSpaceTransforms.Num(); ++BoneIndex) {
+
+		const int32 ParentIndex = RefSkeleton.GetParentIndex(BoneIndex);
+		const FTransform LocalTransform = ParentIndex == INDEX_NONE ? ComponentSpaceTransforms[BoneIndex] : ComponentSpaceTransforms[BoneIndex].GetRelativeTransform(ComponentSpaceTransforms[ParentIndex]);
+
+		OutPose.BoneRotations[BoneIndex] = LocalTransform.GetRotation();
+
+		if (BoneIndex == 0) {
+
+			OutPose.RootTranslation = LocalTransform.GetTranslation();
+		}
+	}
+}
+
+void ASurvivalCorpse::ApplyPose(const FCorpsePose& InPose) {
+
+	const FReferenceSkeleton& RefSkeleton = PoseMesh->RefSkeleton;
+	const int32 NumBones = FMath::Min(InPose.BoneRotations.Num(), RefSkeleton.GetNum());
+
+	// The merged mesh may order its bones differently, match them by name
+	for (int32 BoneIndex = 0; BoneIndex < NumBones; ++BoneIndex) {
+
+		const int32 CorpseBoneIndex = CorpseMesh->GetBoneIndex(RefSkeleton.GetBoneName(BoneIndex));
+
+		if (CorpseMesh->BoneSpaceTransforms.IsValidIndex(CorpseBoneIndex)) {
+
+			CorpseMesh->BoneSpaceTransforms[CorpseBoneIndex].SetRotation(InPose.BoneRotations[BoneIndex]);
+
+			if (BoneIndex == 0) {
+
+				CorpseMesh->BoneSpaceTransforms[CorpseBoneIndex].SetTranslation(InPose.RootTranslation);
+			}
+		}
+	}
+
+	CorpseMesh->MarkRefreshTransformDirty();
+}
+
+void ASurvivalCorpse::CalcCamera(float DeltaTime, struct FMinimalViewInfo& OutResult) {
+
+	// Orbit above the body, the dead player still turns the camera with the mouse.
+	// The corpse is spawned owned by that player's controller, which also holds on listen servers and in splitscreen
+	const APlayerController* PC = Cast<APlayerController>(GetOwner());
+	const FRotator ViewRotation = PC ? PC->GetControlRotation() : GetActorRotation();
+
+	const FVector Pivot = GetActorLocation() + FVector(0.f, 0.f, DeathCameraHeight);
+	FVector ViewLocation = Pivot - ViewRotation.Vector() * DeathCameraDistance;
+
+	FHitResult Hit;
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(CorpseCamera), false, this);
+
+	if (GetWorld()->SweepSingleByChannel(Hit, Pivot, ViewLocation, FQuat::Identity, ECC_Camera, FCollisionShape::MakeSphere(12.f), QueryParams)) {
+
+		ViewLocation = Hit.Location;
+	}
+
+	OutResult.Location = ViewLocation;
+	OutResult.Rotation = ViewRotation;
+	OutResult.FOV = 90.f;
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "Components/SkinnedMeshComponent.h"
 #include "Items/EquippableItem.h"
 #include "SurvivalCharacter.generated.h"
 
@@ -18,6 +19,7 @@ class USkeletalMeshComponent;
 class UInteractionComponent;
 class UAnimMontage;
 class AThrowableItem;
+class UDamageType;
 
 USTRUCT()
 struct FInteractionData
@@ -44,11 +46,87 @@ struct FInteractionData
 	bool bInteractHeld;
 };
 
+/** Gear worn in each slot, replicated to other players so they can dress the character without receiving its inventory */
+USTRUCT()
+struct FEquipmentAppearance
+{
+	GENERATED_BODY()
+
+	FEquipmentAppearance() {
+
+		Gear.SetNumZeroed(NumEquippableSlots);
+	}
+
+	// Gear class worn in each slot, indexed by EEquippableSlot. NULL shows the naked mesh.
+	UPROPERTY()
+	TArray<TSubclassOf<class UGearItem>> Gear;
+
+	// Writes a bit per slot, followed by the class net GUID of occupied slots only
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	bool operator==(const FEquipmentAppearance& Other) const { return Gear == Other.Gear; }
+};
+
+template<>
+struct TStructOpsTypeTraits<FEquipmentAppearance> : public TStructOpsTypeTraitsBase2<FEquipmentAppearance>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true
+	};
+};
+
+/** Damage one instigator dealt to a character within a frame */
+struct FDamageContribution
+{
+	TWeakObjectPtr<AController> EventInstigator;
+
+	TWeakObjectPtr<AActor> DamageCauser;
+
+	TSubclassOf<UDamageType> DamageTypeClass;
+
+	float Damage = 0.f;
+
+	int32 Hits = 0;
+};
+
+/** Secondary character tick, lets per-frame work run at its own interval and only where it is needed */
+USTRUCT()
+struct FSurvivalCharacterTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	FSurvivalCharacterTickFunction() : Target(nullptr), TickMethod(nullptr) {};
+
+	class ASurvivalCharacter* Target;
+
+	void (ASurvivalCharacter::*TickMethod)(float DeltaTime);
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FSurvivalCharacterTickFunction> : public TStructOpsTypeTraitsBase2<FSurvivalCharacterTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
 UCLASS()
 class SURVIVALGAME_API ASurvivalCharacter : public ACharacter
 {
 	GENERATED_BODY()
 
+	// Soak bots drive the character through the same protected input functions a player does
+	friend class ASurvivalSoakBotController;
+
+	// Counts the enabled tick functions for the tick cost report
+	friend class ASurvivalSoakRunner;
+
 public:
 	ASurvivalCharacter();
 
@@ -72,12 +150,20 @@ public:
 
 	// Gets all equipped items from players
 	UFUNCTION(BlueprintPure)
-	FORCEINLINE TMap<EEquippableSlot, UEquippableItem*> GetEquippment() const { return  EquippedItems; };
+	TMap<EEquippableSlot, UEquippableItem*> GetEquippment() const;
+
+	// Returns item equipped in given slot, NULL if the slot is empty
+	UFUNCTION(BlueprintPure, Category = "Player|Inventory")
+	FORCEINLINE UEquippableItem* GetEquippedItem(const EEquippableSlot Slot) const { return EquippedItems[static_cast<int32>(Slot)]; };
+
+	// Whether given slot is occupied. Replicated to everyone, also valid before the equipped items themselves arrive.
+	UFUNCTION(BlueprintPure, Category = "Player|Inventory")
+	FORCEINLINE bool IsSlotEquipped(const EEquippableSlot Slot) const { return (EquippedSlotMask & (1 << static_cast<int32>(Slot))) != 0; };
 
 	// Returns Skeletal Mesh Component that occupies given slot.
 	// If none found returns NULL value
 	UFUNCTION(BlueprintPure, Category = "Player|Inventory")
-	class USkeletalMeshComponent* GetSlotSkeletalMeshComponent(const EEquippableSlot Slot);
+	FORCEINLINE class USkeletalMeshComponent* GetSlotSkeletalMeshComponent(const EEquippableSlot Slot) const { return SlotMeshes[static_cast<int32>(Slot)]; };
 
 	bool EquipItem(class UEquippableItem* Item);
 	bool UnEquipItem(class UEquippableItem* Item);
@@ -85,6 +171,12 @@ public:
 	bool EquipGear(class UGearItem* Gear);
 	bool UnEquipGear(const EEquippableSlot Slot);
 
+	// Shows given gear in its slot, or the naked mesh when Gear is NULL. Also used with class defaults on simulated proxies.
+	void ApplyGearAppearance(const EEquippableSlot Slot, const class UGearItem* Gear);
+
+	// Rebuilds the merged gear mesh on the next tick, so all gear swaps of this frame end up in one merge
+	void RequestGearMeshMerge();
+
 	bool EquipWeapon(class UWeaponItem* WeaponItem);
 	bool UnEquipWeapon();
 
@@ -104,12 +196,14 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Player|Inventory")
 	bool GetIsLooting() const;
 
+	FORCEINLINE class UInventoryComponent* GetLootSource() const { return LootSource; };
+
 #pragma endregion LOOTING_public
 
 #pragma region WEAPON_public
 
 	UFUNCTION()
-	void OnRep_Weapon();
+	void OnRep_Weapon(class AWeaponActor* OldWeapon);
 
 	// Whether player aims or not
 	UFUNCTION(BlueprintPure, Category = "Player|Firing")
@@ -138,11 +232,34 @@ public:
 
 protected:
 
+	virtual void PostInitializeComponents() override;
 	virtual void BeginPlay() override;
-	virtual void Tick(float DeltaTime) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Destroyed() override;
+	virtual void RegisterActorTickFunctions(bool bRegister) override;
 	virtual void Restart() override;
+	virtual void UnPossessed() override;
+
+	// Local player only: FOV and ADS camera interpolation. Never registered on dedicated server.
+	void TickCamera(float DeltaTime);
+
+	// Interactable lookup. Local player at InteractionCheckFrequency, server only while interacting.
+	void TickInteraction(float DeltaTime);
+
+	// Significance tier of this character seen from the given viewpoint. Called from the significance manager, possibly off the game thread.
+	float CalculateSignificance(const FTransform& Viewpoint) const;
+
+	// Scales tick and animation update rates of this character and its weapon to the new significance tier
+	void OnSignificanceChanged(const float OldSignificance, const float NewSignificance);
+
+	// Applies the tick interval of the current significance tier to the equipped weapon mesh
+	void ApplySignificanceToWeapon();
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
+	// Both only report to survival.NetAccounting and stat SurvivalGame
+	virtual bool ReplicateSubobjects(class UActorChannel* Channel, class FOutBunch* Bunch, FReplicationFlags* RepFlags) override;
+	virtual bool CallRemoteFunction(UFunction* Function, void* Parameters, struct FOutParmRec* OutParms, FFrame* Stack) override;
+
 	void MoveForward(float Value);
 	void MoveRight(float Value);
 	void LookUp(float Value);
@@ -198,6 +315,21 @@ protected:
 	UFUNCTION(Server, Reliable, WithValidation)
 	void ServerDropItem(class UItem* Item, const int32 Quantity);
 
+	UFUNCTION()
+	void OnRep_EquipmentAppearance(const FEquipmentAppearance& OldAppearance);
+
+	UFUNCTION()
+	void OnGearChanged(const EEquippableSlot Slot, const UEquippableItem* Item);
+
+	// Whether this character should be drawn with a single merged gear mesh
+	bool ShouldMergeGearMeshes() const;
+
+	// Replaces the separate body and gear meshes with one merged mesh, shared with every character wearing the same gear
+	void MergeGearMeshes();
+
+	// Shows the separate body and gear meshes again
+	void ClearMergedGearMesh();
+
 #pragma endregion INVENTORY_protected
 
 #pragma region LOOTING_protected
@@ -238,17 +370,36 @@ protected:
 	UFUNCTION()
 	void KilledBy(struct FDamageEvent const& DamageEvent, const class AController* EventInstigator, const AActor* DamageCauser);
 
+	/** Queues the damage, everything taken within a frame is applied together by ResolvePendingDamage.*/
 	virtual float TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
 
+	/** Applies the queued damage as one health change, the biggest contributor gets the kill.*/
+	void ResolvePendingDamage();
+
+	/** Hands inventory and pose over to a corpse actor and destroys this character. Server only.*/
+	void ConvertToCorpse();
+
 #pragma endregion HEALTH_protected
 
 #pragma region COMBAT_protected
 
 	void BeginMeleeAttack();
 
-	/** Process the melee hit.*/
+	// Opens the active window of the swing, hits are only detected between MeleeActiveStart and MeleeActiveEnd
+	void StartMeleeSwing();
+
+	void EndMeleeSwing();
+
+	// Local player only: sweeps the hit sphere from where the melee socket was last frame to where it is now
+	void TickMeleeSwing(float DeltaTime);
+
+	/** Starts the swing on the server.*/
+	UFUNCTION(Server, Reliable, WithValidation)
+	void Server_MeleeAttack();
+
+	/** Process the melee hit. The server sweeps the reported segment against the victim alone before applying damage.*/
 	UFUNCTION(Server, Reliable, WithValidation)
-	void Server_MeleeAttack(const FHitResult& MeleeHit);
+	void Server_MeleeHit(const FHitResult& MeleeHit);
 
 	UFUNCTION(NetMulticast, Unreliable)
 	void MulticastPlayMeleeFX();
@@ -326,6 +477,10 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 	USkeletalMeshComponent* BackpackMesh = nullptr;
 
+	// Draws body and gear as one mesh for remote characters, see bMergeGearMeshes
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USkeletalMeshComponent* MergedGearMesh = nullptr;
+
 #pragma endregion COMPONENTS
 
 #pragma region INTERACTION_protected_variables
@@ -351,16 +506,37 @@ protected:
 	TSubclassOf<class APickup> PickupClass;
 
 	// The player body meshes map to equipment slots
+	// Blueprint view only, native code uses SlotMeshes
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Inventory")
 	TMap<EEquippableSlot, USkeletalMeshComponent*> PlayerMeshes;
 
-	// Default mesh if no equippment available
+	// The player body meshes indexed by equipment slot, NULL for slots without a mesh
 	UPROPERTY(VisibleAnywhere, Category = "Inventory")
-	TMap<EEquippableSlot, USkeletalMesh*> NakedMeshes;
+	TArray<USkeletalMeshComponent*> SlotMeshes;
 
-	// The player equipped items map to equipment slots
+	// Default mesh if no equippment available, indexed by equipment slot
 	UPROPERTY(VisibleAnywhere, Category = "Inventory")
-	TMap<EEquippableSlot, UEquippableItem*> EquippedItems;
+	TArray<USkeletalMesh*> NakedMeshes;
+
+	// The player equipped items indexed by equipment slot
+	UPROPERTY(VisibleAnywhere, Category = "Inventory")
+	TArray<UEquippableItem*> EquippedItems;
+
+	// One bit per equipment slot, set while the slot is occupied
+	UPROPERTY(Replicated)
+	uint16 EquippedSlotMask;
+
+	// What other players see this character wearing, the owner dresses from its own equipped items
+	UPROPERTY(ReplicatedUsing = OnRep_EquipmentAppearance)
+	FEquipmentAppearance EquipmentAppearance;
+
+	// Merge body and gear of remote characters into one skeletal mesh, trades a merge on gear change for fewer draw calls and skinning passes
+	UPROPERTY(EditDefaultsOnly, Category = "Inventory")
+	bool bMergeGearMeshes;
+
+	bool bGearMeshesMerged;
+
+	bool bGearMeshMergePending;
 
 #pragma endregion INVENTORY_protected_variables
 
@@ -386,6 +562,21 @@ protected:
 	UPROPERTY(ReplicatedUsing = OnRep_Killer, VisibleAnywhere, BlueprintReadOnly, Category = "Player|Health")
 	class ASurvivalCharacter* Killer = nullptr;
 
+	// Damage taken this frame, one entry per instigator
+	TArray<FDamageContribution> PendingDamage;
+
+	bool bDamageResolvePending;
+
+	/** Lightweight loot actor replacing the dead body, the body stays a full character when not set.*/
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Player|Health")
+	TSubclassOf<class ASurvivalCorpse> CorpseClass;
+
+	/** How many seconds the ragdoll simulates before the character is replaced by the corpse.*/
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Player|Health", meta = (ClampMin = 0))
+	float CorpseConversionDelay;
+
+	FTimerHandle TimerHandle_ConvertToCorpse;
+
 #pragma endregion HEALTH_protected_variables
 
 #pragma region MELEE_protected_variables
@@ -399,6 +590,26 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "Combat|Melee")
 	float MeleeAttackDamage;
 
+	// Socket swept during the swing, usually the hand or the tip of the held weapon
+	UPROPERTY(EditDefaultsOnly, Category = "Combat|Melee")
+	FName MeleeSocketName;
+
+	// Radius of the sphere swept along the swing
+	UPROPERTY(EditDefaultsOnly, Category = "Combat|Melee", meta = (ClampMin = 1))
+	float MeleeHitRadius;
+
+	// Seconds into the montage the swing starts hitting
+	UPROPERTY(EditDefaultsOnly, Category = "Combat|Melee", meta = (ClampMin = 0))
+	float MeleeActiveStart;
+
+	// Seconds into the montage the swing stops hitting
+	UPROPERTY(EditDefaultsOnly, Category = "Combat|Melee", meta = (ClampMin = 0))
+	float MeleeActiveEnd;
+
+	// Extra radius and time the server allows for the victim having moved between client and server
+	UPROPERTY(EditDefaultsOnly, Category = "Combat|Melee", meta = (ClampMin = 0))
+	float MeleeHitTolerance;
+
 	UPROPERTY(EditDefaultsOnly, Category = "Combat|Melee")
 	TSubclassOf<class UMeleeDamage> MeleeDamageTypeClass;
 
@@ -418,6 +629,10 @@ protected:
 	UPROPERTY(VisibleAnywhere, ReplicatedUsing = OnRep_Weapon)
 	class AWeaponActor* EquippedWeapon = nullptr;
 
+	// Weapon actors spawned by this player, kept hidden and dormant while unequipped so swapping back does not spawn a new actor
+	UPROPERTY(Transient)
+	TMap<TSubclassOf<class AWeaponActor>, class AWeaponActor*> WeaponCache;
+
 	UPROPERTY(Transient, Replicated)
 	bool bIsAiming;
 
@@ -437,7 +652,32 @@ protected:
 	UPROPERTY(Replicated, BlueprintReadOnly, Category = "Movement")
 	bool bIsSprinting;
 
+	// Tick interval of the current significance tier, 0 means every frame
+	float SignificanceTickInterval;
+
+	// Mesh anim tick option set in the editor, restored when the character becomes significant again
+	EVisibilityBasedAnimTickOption DefaultAnimTickOption;
+
 private:
 
 	FTimerHandle TimerHandle_Interaction;
+
+	FSurvivalCharacterTickFunction CameraTickFunction;
+
+	FSurvivalCharacterTickFunction InteractionTickFunction;
+
+	FSurvivalCharacterTickFunction MeleeTickFunction;
+
+	FTimerHandle TimerHandle_MeleeWindow;
+
+	FVector LastMeleeSocketLocation;
+
+	// Time spent sweeping during the current swing
+	uint32 MeleeSwingCycles;
+
+	// Actors hit by the current swing, each takes damage once per swing
+	TArray<TWeakObjectPtr<AActor>> MeleeSwingHits;
+
+	// Same for the server side of the swing, kept apart so a listen server does not reject its own hits
+	TArray<TWeakObjectPtr<AActor>> MeleeServerHits;
 };
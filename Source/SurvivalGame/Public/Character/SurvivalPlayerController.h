@@ -22,6 +22,11 @@ public:
 
 	virtual void SetupInputComponent() override;
 
+	virtual void PlayerTick(float DeltaTime) override;
+
+	// Counts our RPCs and reports their size to survival.NetAccounting
+	virtual bool CallRemoteFunction(UFunction* Function, void* Parameters, struct FOutParmRec* OutParms, FFrame* Stack) override;
+
 	UFUNCTION(BlueprintImplementableEvent)
 	void ShowIngameUI();
 
@@ -49,12 +54,7 @@ public:
 	UFUNCTION(Server, Reliable, WithValidation)
 	void ServerRespawn();
 
-	// Applies recoil to camera
-	// @param RecoilAmount		the amount of recoil by X (yaw) and Y (pitch)
-	// @param RecoilSpeed		the speed to bump the camera up per second from the recoil
-	// @param RecoilResetSpee	the speed the camera will return to the center per second after finished recoil
-	// @param Shake				optional camera shake to play with recoil 
-	void ApplyRecoil(const FVector2D RecoildAmount, float RecoilSpeed, float RecoilResetSpeed, TSubclassOf<UCameraShake> FireCameraShake);
+	FORCEINLINE class URecoilComponent* GetRecoil() const { return Recoil; };
 
 	UFUNCTION(Client, Unreliable)
 	void ClientShotHitConfirmed();
@@ -67,20 +67,6 @@ protected:
 
 protected:
 
-	UPROPERTY(VisibleAnywhere, Category = "Recoil")
-	FVector2D RecoilBumpAmount;
-
-	UPROPERTY(VisibleAnywhere, Category = "Recoil")
-	FVector2D RecoilResetAmount;
-
-	UPROPERTY(EditDefaultsOnly, Category = "Recoil")
-	float CurrentRecoilSpeed;
-
-	UPROPERTY(EditDefaultsOnly, Category = "Recoil")
-	float CurrentRecoilResetSpeed;
-
-	UPROPERTY(VisibleAnywhere, Category = "Recoil")
-	float LastRecoilTime;
-
-
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	class URecoilComponent* Recoil = nullptr;
 };
@@ -0,0 +1,77 @@
+// All rights reserved Dominik Pavlicek
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Controller.h"
+#include "SurvivalSoakBotController.generated.h"
+
+class ASurvivalCharacter;
+
+/**
+ * Minimal server side brain for the soak test, see ASurvivalSoakRunner.
+ * Wanders around, loots the nearest pickup, lootable or corpse, equips the first weapon it finds
+ * and shoots at whoever is close. Everything goes through the same character functions a player uses,
+ * so the soak exercises the real gameplay code paths.
+ */
+UCLASS(NotBlueprintable, Transient)
+class SURVIVALGAME_API ASurvivalSoakBotController : public AController
+{
+	GENERATED_BODY()
+
+public:
+
+	ASurvivalSoakBotController();
+
+	virtual void Tick(float DeltaTime) override;
+
+	// Seeds the decisions of this bot so a soak run can be repeated
+	void InitBot(const int32 Seed);
+
+protected:
+
+	virtual void OnUnPossess() override;
+
+	// Picks what to do next, runs every DecisionInterval
+	void Think(ASurvivalCharacter* Character);
+
+	// Returns the closest actor with an interaction component we can use, or null
+	AActor* FindLootTarget(ASurvivalCharacter* Character) const;
+
+	// Returns the closest living character other than us within EngageRange, or null
+	ASurvivalCharacter* FindEnemy(ASurvivalCharacter* Character) const;
+
+	// Interacts with the loot target and takes the first item if it opened a loot source
+	void LootTarget(ASurvivalCharacter* Character);
+
+	// Equips the first weapon in our inventory if we have none equipped
+	void EquipAnyWeapon(ASurvivalCharacter* Character);
+
+	void SetFiring(ASurvivalCharacter* Character, const bool bNewFiring);
+
+	UPROPERTY(EditDefaultsOnly, Category = "Soak")
+	float DecisionInterval;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Soak")
+	float WanderRadius;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Soak")
+	float LootSearchRadius;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Soak")
+	float EngageRange;
+
+	UPROPERTY(Transient)
+	AActor* CurrentLootTarget = nullptr;
+
+	UPROPERTY(Transient)
+	ASurvivalCharacter* CurrentEnemy = nullptr;
+
+	FRandomStream Stream;
+
+	FVector WanderTarget;
+
+	float NextDecisionTime;
+
+	bool bFiring;
+};
@@ -0,0 +1,89 @@
+// All rights reserved Dominik Pavlicek
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Engine/EngineTypes.h"
+#include "WorldCollision.h"
+#include "AreaDamageComponent.generated.h"
+
+class ASurvivalCharacter;
+class UDamageType;
+
+/**
+ * Server side area of effect damage for explosions.
+ * Each explosion is one query against a grid of characters, followed by one async occlusion trace per candidate.
+ * Damage is applied once the traces finished, usually the next frame, as one TakeDamage per character and explosion.
+ * Lives on the game state.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class SURVIVALGAME_API UAreaDamageComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UAreaDamageComponent();
+
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** Queues an explosion at Origin. Server only.
+	* @param bDryRun	- Runs the queries and traces without damaging anyone, used by the benchmark
+	*/
+	void ApplyAreaDamage(const FVector& Origin, const FRadialDamageParams& Params, TSubclassOf<UDamageType> DamageTypeClass, AActor* DamageCauser, AController* InstigatedBy, const bool bDryRun = false);
+
+	FORCEINLINE int32 GetNumPendingExplosions() const { return PendingExplosions.Num(); };
+
+protected:
+
+	// Buckets all living characters into grid cells, at most once per frame
+	void UpdateSpatialIndex();
+
+	// Characters whose capsule bounds are within Radius of Origin
+	void GatherVictims(const FVector& Origin, const float Radius, TArray<ASurvivalCharacter*>& OutVictims) const;
+
+	// Applies damage of all explosions whose occlusion traces finished
+	void ResolveExplosions();
+
+	FIntPoint GetCell(const FVector& Location) const;
+
+protected:
+
+	// Edge length of a spatial index cell, roughly the largest explosion radius
+	UPROPERTY(EditDefaultsOnly, Category = "Area Damage", meta = (ClampMin = 100))
+	float CellSize;
+
+	// Geometry blocking this channel shields characters from explosions
+	UPROPERTY(EditDefaultsOnly, Category = "Area Damage")
+	TEnumAsByte<ECollisionChannel> OcclusionChannel;
+
+private:
+
+	struct FPendingVictim
+	{
+		TWeakObjectPtr<ASurvivalCharacter> Character;
+		FVector ClosestPoint;
+		float Distance;
+		FTraceHandle OcclusionTrace;
+	};
+
+	struct FPendingExplosion
+	{
+		FVector Origin;
+		FRadialDamageParams Params;
+		TSubclassOf<UDamageType> DamageTypeClass;
+		TWeakObjectPtr<AActor> DamageCauser;
+		TWeakObjectPtr<AController> InstigatedBy;
+		TArray<FPendingVictim> Victims;
+		uint64 IssueFrame;
+		bool bDryRun;
+	};
+
+	TArray<FPendingExplosion> PendingExplosions;
+
+	// Only valid during SpatialIndexFrame, characters are not kept alive by it
+	TMap<FIntPoint, TArray<ASurvivalCharacter*>> CharacterGrid;
+
+	uint64 SpatialIndexFrame;
+};
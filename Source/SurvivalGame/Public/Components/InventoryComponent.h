@@ -97,6 +97,9 @@ class SURVIVALGAME_API UInventoryComponent : public UActorComponent
 
 	friend class UItem;
 
+	// survival.BenchInventory times the internal paths and restores the inventory between runs
+	friend struct FInventoryBenchmark;
+
 public:	
 
 	UInventoryComponent();
@@ -151,8 +154,15 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Inventory")
 	TArray<UItem*> FindItemsByClass(TSubclassOf<UItem> ItemClass) const;
 
+	// On clients, entries for items not replicated to this machine are NULL
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	FORCEINLINE const TArray<class UItem*>& GetItems() const { return Items; };
+
+	/** Returns a copy of Items without the entries not replicated to this machine yet
+	* Usage: Client side UI refreshes from OnInventoryUpdated. Allocates, so keep it out of per frame code.
+	*/
 	UFUNCTION(BlueprintPure, Category = "Inventory")
-	FORCEINLINE TArray<class UItem*> GetItems() const { return Items; };
+	TArray<class UItem*> GetReplicatedItems() const;
 
 	UFUNCTION(BlueprintPure, Category = "Inventory")
 	FORCEINLINE int32 GetCapacity() const { return Capacity; };
@@ -172,11 +182,21 @@ public:
 	UFUNCTION(Client, Reliable)
 	void ClientRefreshInventory();
 
+	/** Whether items of this inventory are replicated to given connection.
+	* The owner always receives them, everyone else only while looting this inventory.
+	* Loot containers and corpses are dormant, so no distance rule here, it would only be checked when they happen to be awake.
+	* ASurvivalCharacter::SetLootingSource flushes their dormancy instead, which sends the items as the loot menu opens.
+	*/
+	bool ShouldReplicateItemsTo(const class UNetConnection* Connection) const;
+
 protected:
 
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 	virtual bool ReplicateSubobjects(class UActorChannel *Channel, class FOutBunch *Bunch, FReplicationFlags *RepFlags) override;
 
+	// Counts our RPCs and reports their size to survival.NetAccounting, under the owner's class
+	virtual bool CallRemoteFunction(UFunction* Function, void* Parameters, struct FOutParmRec* OutParms, FFrame* Stack) override;
+
 private:
 
 	UFUNCTION()
@@ -0,0 +1,65 @@
+// All rights reserved Dominik Pavlicek
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "RagdollBudgetComponent.generated.h"
+
+class USkeletalMeshComponent;
+
+/**
+ * Caps the number of simulating ragdolls, the budget is survival.MaxActiveRagdolls and can be set per platform.
+ * Ragdolls that settled and the oldest ones above the budget are frozen into their current pose,
+ * physics off and no further skeleton updates, so a body costs nothing but drawing.
+ * Lives on the game state.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class SURVIVALGAME_API URagdollBudgetComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	URagdollBudgetComponent();
+
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	// Starts tracking a mesh that just started simulating, may freeze the oldest ragdoll to make room.
+	// Meshes are held weakly, one destroyed with its character or corpse drops out on the next budget check.
+	void RegisterRagdoll(USkeletalMeshComponent* Mesh);
+
+	// Stops the simulation and keeps the mesh in its current pose
+	static void FreezeRagdoll(USkeletalMeshComponent* Mesh);
+
+protected:
+
+	// Freezes settled ragdolls, then the oldest ones until the budget is met
+	void EnforceBudget();
+
+protected:
+
+	// Below this speed, in cm/s, a ragdoll counts as resting
+	UPROPERTY(EditDefaultsOnly, Category = "Ragdoll", meta = (ClampMin = 0))
+	float SettleSpeed;
+
+	// How long a ragdoll has to rest before it is frozen
+	UPROPERTY(EditDefaultsOnly, Category = "Ragdoll", meta = (ClampMin = 0))
+	float SettleTime;
+
+	// Ragdolls are never frozen younger than this, even over budget, so deaths still read as deaths
+	UPROPERTY(EditDefaultsOnly, Category = "Ragdoll", meta = (ClampMin = 0))
+	float MinSimulationTime;
+
+private:
+
+	struct FActiveRagdoll
+	{
+		TWeakObjectPtr<USkeletalMeshComponent> Mesh;
+		float StartTime;
+		float RestingSince;
+	};
+
+	// Oldest first
+	TArray<FActiveRagdoll> ActiveRagdolls;
+};
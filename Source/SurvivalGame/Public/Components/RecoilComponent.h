@@ -0,0 +1,69 @@
+// All rights reserved Dominik Pavlicek
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "RecoilComponent.generated.h"
+
+/**
+ * Camera recoil of the local player. Shots add a kick that is applied over a few frames and then slowly recovered.
+ * Simulated once per frame in fixed substeps, so the camera path only depends on the shots and not on the frame rate.
+ * Lives on the player controller.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class SURVIVALGAME_API URecoilComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	URecoilComponent();
+
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	// Kick of one shot from a baked recoil curve, yaw and pitch are picked by the seed so the same seed always kicks the same way
+	static FVector2D SampleRecoil(const TArray<FVector2D>& RecoilTable, const int32 Seed);
+
+	/** Adds a kick of given yaw (X) and pitch (Y).
+	* @param RecoilSpeed	- How fast the kick is applied per second
+	* @param ResetSpeed		- How fast the camera returns to the center per second
+	*/
+	void AddRecoil(const FVector2D& Amount, const float RecoilSpeed, const float ResetSpeed);
+
+	// Player look input, aiming against the recoil cancels that much of the recovery
+	void CompensateInput(const FVector2D& Input);
+
+	void ResetRecoil();
+
+	FORCEINLINE bool IsRecoiling() const { return !BumpAmount.IsNearlyZero(0.01f) || !ResetAmount.IsNearlyZero(0.01f); };
+
+protected:
+
+	// Advances the kick and the recovery by one fixed step, returns the camera delta of that step
+	FVector2D Step(const float StepTime);
+
+protected:
+
+	// Length of one simulation step
+	UPROPERTY(EditDefaultsOnly, Category = "Recoil", meta = (ClampMin = 0.001, ClampMax = 0.05))
+	float FixedTimeStep;
+
+	// Upper bound of steps per frame, after a hitch the rest of the recoil is simply dropped
+	UPROPERTY(EditDefaultsOnly, Category = "Recoil", meta = (ClampMin = 1))
+	int32 MaxStepsPerFrame;
+
+private:
+
+	// Kick not yet applied to the camera
+	FVector2D BumpAmount;
+
+	// Kick not yet recovered
+	FVector2D ResetAmount;
+
+	float RecoilSpeed;
+	float ResetSpeed;
+
+	// Frame time not yet simulated
+	float TimeAccumulator;
+};
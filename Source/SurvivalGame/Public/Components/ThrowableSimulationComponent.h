@@ -0,0 +1,82 @@
+// All rights reserved Dominik Pavlicek
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "CollisionQueryParams.h"
+#include "ThrowableSimulationComponent.generated.h"
+
+class AThrowableWeapon;
+
+/** Flight state of one throwable, kept flat so all of them advance in one loop */
+struct FThrowableSimulationState
+{
+	TWeakObjectPtr<AThrowableWeapon> Throwable;
+
+	FVector Location;
+	FVector PreviousLocation;
+	FVector Velocity;
+
+	// Server time of the last simulated step
+	float SimulationTime;
+
+	float GravityZ;
+	float Bounciness;
+	float Friction;
+	float StopSimulatingSpeed;
+	bool bShouldBounce;
+	bool bRotationFollowsVelocity;
+	bool bAtRest;
+
+	FCollisionShape Shape;
+	ECollisionChannel CollisionChannel;
+	FCollisionQueryParams QueryParams;
+	FCollisionResponseParams ResponseParams;
+};
+
+/**
+ * Advances every thrown item in flight with a fixed substep, replacing one projectile movement tick per throwable.
+ * Server and clients start from the same replicated launch data and server time, so they follow the same ballistic path without replicating movement.
+ * Lives on the game state.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class SURVIVALGAME_API UThrowableSimulationComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UThrowableSimulationComponent();
+
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	// Starts simulating given throwable from its launch data, catching up to the current server time
+	void RegisterThrowable(AThrowableWeapon* Throwable);
+
+	void UnregisterThrowable(AThrowableWeapon* Throwable);
+
+protected:
+
+	// Advances every throwable to given server time in fixed steps and moves the actors to the interpolated location
+	void AdvanceTo(const float ServerTime);
+
+	// Single fixed step of one throwable, sweeps against the world and bounces
+	void Step(FThrowableSimulationState& State, UWorld* World) const;
+
+	float GetServerTime() const;
+
+protected:
+
+	// Simulation step length, identical on server and clients to keep their paths together
+	UPROPERTY(EditDefaultsOnly, Category = "Throwable", meta = (ClampMin = 0.005, ClampMax = 0.1))
+	float FixedTimeStep;
+
+	// Upper bound of steps per throwable and frame, late joiners catch up over a few frames
+	UPROPERTY(EditDefaultsOnly, Category = "Throwable", meta = (ClampMin = 1))
+	int32 MaxStepsPerFrame;
+
+private:
+
+	TArray<FThrowableSimulationState> Simulations;
+};
@@ -6,6 +6,9 @@
 #include "Engine/GameInstance.h"
 #include "SurvivalGameInstance.generated.h"
 
+class USkeletalMesh;
+class USkeleton;
+
 /**
  * 
  */
@@ -13,5 +16,30 @@ UCLASS()
 class SURVIVALGAME_API USurvivalGameInstance : public UGameInstance
 {
 	GENERATED_BODY()
-	
+
+public:
+
+	USurvivalGameInstance();
+
+	/**
+	 * Returns a single skeletal mesh built from the given parts, merging them on first request.
+	 * Characters wearing the same gear combination share the merged mesh.
+	 * Source meshes must have CPU access enabled to be merged in cooked builds.
+	 */
+	USkeletalMesh* GetMergedCharacterMesh(const TArray<USkeletalMesh*>& SourceMeshes, USkeleton* Skeleton);
+
+protected:
+
+	// How many gear combinations are kept merged at the same time
+	UPROPERTY(EditDefaultsOnly, Category = "Character", meta = (ClampMin = 1))
+	int32 MaxMergedCharacterMeshes;
+
+private:
+
+	// Merged character meshes keyed by the path names of their source meshes, null for combinations that failed to merge
+	UPROPERTY(Transient)
+	TMap<FString, USkeletalMesh*> MergedCharacterMeshes;
+
+	// Keys of MergedCharacterMeshes, least recently used first
+	TArray<FString> MergedCharacterMeshKeys;
 };
@@ -13,5 +13,23 @@ UCLASS()
 class SURVIVALGAME_API ASurvivalGameStateBase : public AGameStateBase
 {
 	GENERATED_BODY()
-	
+
+public:
+
+	ASurvivalGameStateBase();
+
+	FORCEINLINE class UThrowableSimulationComponent* GetThrowableSimulation() const { return ThrowableSimulation; };
+	FORCEINLINE class UAreaDamageComponent* GetAreaDamage() const { return AreaDamage; };
+	FORCEINLINE class URagdollBudgetComponent* GetRagdollBudget() const { return RagdollBudget; };
+
+protected:
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	class UThrowableSimulationComponent* ThrowableSimulation = nullptr;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	class UAreaDamageComponent* AreaDamage = nullptr;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	class URagdollBudgetComponent* RagdollBudget = nullptr;
 };
@@ -0,0 +1,79 @@
+// All rights reserved Dominik Pavlicek
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+class UFunction;
+class UNetConnection;
+class UActorChannel;
+class FOutBunch;
+
+/**
+ * Per connection replication bandwidth accounting, enabled with survival.NetAccounting <DumpIntervalSeconds>.
+ * Gameplay classes report what they write into each connection's bunches: actor properties, components and
+ * subobjects (inventory items) per class, and RPCs per function. Every interval the totals are appended
+ * to Saved/Profiling/NetAccounting/NetAccounting-<date>.csv and reset. The rows don't overlap, an item written
+ * by a character's inventory is a Subobject row and not part of the character's ComponentsAndSubobjects.
+ * A server records what it sends to each client, a client records what it sends to the server, so enable it on a client for server RPC costs.
+ * Property level detail inside an actor comes from a netprofile capture, this answers which class and connection the bytes go to.
+ */
+class SURVIVALGAME_API FSurvivalNetAccounting
+{
+public:
+
+	static bool IsEnabled();
+
+	static void RecordBits(UNetConnection* Connection, const FName ClassName, const FName Entry, const int64 Bits);
+
+	struct FScopedSubobjectReplication;
+
+	// Wraps ReplicateSubobjects of an actor. At this point the bunch holds the replicated properties,
+	// what Super::ReplicateSubobjects adds are the components and their subobjects.
+	// Subobjects recorded on their own while in scope, eg. inventory items, are left out of ComponentsAndSubobjects so no byte is counted twice.
+	struct SURVIVALGAME_API FScopedActorReplication
+	{
+		FScopedActorReplication(const AActor* InActor, UActorChannel* InChannel, const FOutBunch* InBunch);
+		~FScopedActorReplication();
+
+	private:
+
+		friend struct FScopedSubobjectReplication;
+
+		const AActor* Actor;
+		UActorChannel* Channel;
+		const FOutBunch* Bunch;
+		int64 StartBits;
+		int64 SubobjectBits;
+		FScopedActorReplication* OuterScope;
+	};
+
+	// Wraps one replicated subobject, eg. an item written by an inventory or a pickup
+	struct SURVIVALGAME_API FScopedSubobjectReplication
+	{
+		FScopedSubobjectReplication(const UObject* InSubobject, UActorChannel* InChannel, const FOutBunch* InBunch);
+		~FScopedSubobjectReplication();
+
+	private:
+
+		const UObject* Subobject;
+		UActorChannel* Channel;
+		const FOutBunch* Bunch;
+		int64 StartBits;
+	};
+
+	// Wraps CallRemoteFunction, every actor or component sending RPCs overrides it with this scope.
+	// Counts the sent RPC for stat SurvivalGame and, while enabled, charges what it added to each connection's outgoing data
+	struct SURVIVALGAME_API FScopedRemoteFunction
+	{
+		FScopedRemoteFunction(const AActor* InActor, const UFunction* InFunction);
+		~FScopedRemoteFunction();
+
+	private:
+
+		const AActor* Actor;
+		const UFunction* Function;
+		TArray<TPair<UNetConnection*, int64>, TInlineAllocator<1>> StartBits;
+	};
+};
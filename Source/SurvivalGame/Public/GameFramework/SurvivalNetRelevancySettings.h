@@ -0,0 +1,57 @@
+// All rights reserved Dominik Pavlicek
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "SurvivalNetRelevancySettings.generated.h"
+
+/** How much replication attention actors of one class get */
+USTRUCT()
+struct FNetRelevancyProfile
+{
+	GENERATED_BODY()
+
+	// Actors of this class and its children use this profile, the most derived listed class wins
+	UPROPERTY(EditAnywhere, Category = "Relevancy")
+	TSoftClassPtr<AActor> ActorClass;
+
+	// Distance from the viewer beyond which the actor is not relevant
+	UPROPERTY(EditAnywhere, Category = "Relevancy", meta = (ClampMin = 0))
+	float NetCullDistance = 15000.f;
+
+	// Share of bandwidth compared to other actors when saturated
+	UPROPERTY(EditAnywhere, Category = "Relevancy", meta = (ClampMin = 0))
+	float NetPriority = 1.f;
+
+	// How often per second the actor is considered for replication
+	UPROPERTY(EditAnywhere, Category = "Relevancy", meta = (ClampMin = 0))
+	float NetUpdateFrequency = 100.f;
+
+	// Lowest rate adaptive net update frequency backs off to while nothing changes.
+	// Only used when net.UseAdaptiveNetUpdateFrequency is on, that switch covers every replicated actor and is left at the engine default
+	UPROPERTY(EditAnywhere, Category = "Relevancy", meta = (ClampMin = 0))
+	float MinNetUpdateFrequency = 2.f;
+};
+
+/**
+ * Per class network relevancy profiles for world actors, applied when they are spawned.
+ * survival.NetRelevancyReport prints what each class costs on the running server.
+ */
+UCLASS(Config = Game, DefaultConfig, meta = (DisplayName = "Network Relevancy"))
+class SURVIVALGAME_API USurvivalNetRelevancySettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+
+	// Applies the profile matching the class of given actor, if any. Call before the actor first replicates.
+	static void ApplyProfile(AActor* Actor);
+
+	const FNetRelevancyProfile* FindProfile(const UClass* ActorClass) const;
+
+public:
+
+	UPROPERTY(Config, EditAnywhere, Category = "Relevancy")
+	TArray<FNetRelevancyProfile> Profiles;
+};
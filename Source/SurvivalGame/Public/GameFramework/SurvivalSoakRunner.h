@@ -0,0 +1,96 @@
+// All rights reserved Dominik Pavlicek
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "SurvivalSoakRunner.generated.h"
+
+class ASurvivalSoakBotController;
+
+/**
+ * Headless soak test, started on a server with survival.Soak [Bots] [Seconds] [Seed], for example
+ * UE4Editor SurvivalGame <Map> -server -nullrhi -ExecCmds="survival.Soak 32 300" -SoakExit
+ * Spawns bots that move, loot, shoot, take periodic damage, die and respawn. While it runs a stat file
+ * and a csv profile are captured, so stat SurvivalGame and the engine groups can be compared between builds.
+ * At the end it logs frame times, memory and net driver traffic, connect clients to measure replication.
+ * In tick cost mode, survival.Soak 100 60 1 1, the bots stand still and take no damage, so the game thread
+ * mostly runs character ticks. The report then adds the enabled tick functions and game thread time per character.
+ */
+UCLASS(NotBlueprintable, Transient)
+class SURVIVALGAME_API ASurvivalSoakRunner : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+
+	ASurvivalSoakRunner();
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	void StartSoak(const int32 InNumBots, const float InDuration, const int32 InSeed, const bool bInTickCostMode = false);
+
+	// Stops the captures, logs the report and removes the bots
+	void FinishSoak();
+
+protected:
+
+	void SpawnBot(const int32 Index);
+
+	// Deals one hit to a random living bot, instigated by another bot, so characters keep dying
+	void ApplySoakDamage();
+
+	void RespawnBots();
+
+	// Ends the stat file and csv profile
+	void StopCaptures();
+
+	void LogReport() const;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Soak")
+	float DamageInterval;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Soak")
+	float DamagePerHit;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Soak")
+	float RespawnDelay;
+
+	UPROPERTY(Transient)
+	TArray<ASurvivalSoakBotController*> Bots;
+
+	// World time the bot lost its pawn, 0 while it has one
+	TArray<float> BotPawnLostTime;
+
+	FRandomStream Stream;
+
+	int32 NumBots;
+
+	float Duration;
+
+	float StartTime;
+
+	float NextDamageTime;
+
+	bool bRunning;
+
+	bool bTickCostMode;
+
+	// Samples, one per frame
+	TArray<float> FrameTimes;
+	TArray<float> GameThreadTimes;
+
+	uint64 StartUsedPhysical;
+	uint64 PeakUsedPhysical;
+
+	// FMalloc calls when the soak started and when the captures stopped
+	uint64 StartAllocations;
+	uint64 EndAllocations;
+
+	uint32 StartInBytes;
+	uint32 StartOutBytes;
+
+	int32 Respawns;
+};
@@ -22,6 +22,9 @@ enum class EEquippableSlot : uint8 {
 	ESS_DEFAULT			UMETA(DisplayName = "Default")
 };
 
+// Slot count including ESS_DEFAULT, so every slot value is a valid index into per-slot arrays
+static constexpr int32 NumEquippableSlots = static_cast<int32>(EEquippableSlot::ESS_DEFAULT) + 1;
+
 /**
  * 
  */
@@ -4,11 +4,29 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Engine/NetSerialization.h"
 #include "ThrowableWeapon.generated.h"
 
 class UStaticMeshComponent;
 class UProjectileMovementComponent;
 
+/** Initial conditions of a throw, enough for every machine to simulate the same flight */
+USTRUCT()
+struct FThrowableLaunchData
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector_NetQuantize10 Origin;
+
+	UPROPERTY()
+	FVector_NetQuantize10 Velocity;
+
+	// Server world time the throwable left the hand
+	UPROPERTY()
+	float LaunchServerTime = 0.f;
+};
+
 UCLASS()
 class SURVIVALGAME_API AThrowableWeapon : public AActor
 {
@@ -17,12 +35,65 @@ class SURVIVALGAME_API AThrowableWeapon : public AActor
 public:	
 	AThrowableWeapon();
 
+	FORCEINLINE const FThrowableLaunchData& GetLaunchData() const { return LaunchData; };
+	FORCEINLINE UProjectileMovementComponent* GetThrowableMovement() const { return ThrowableMovement; };
+	FORCEINLINE UStaticMeshComponent* GetThrowableMesh() const { return ThrowableMesh; };
+	FORCEINLINE float GetCollisionRadius() const { return CollisionRadius; };
+
+protected:
+
+	virtual void PostInitializeComponents() override;
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	// Counts our RPCs and reports their size to survival.NetAccounting
+	virtual bool CallRemoteFunction(UFunction* Function, void* Parameters, struct FOutParmRec* OutParms, FFrame* Stack) override;
+
+	// Hands the flight to the game state simulation, falls back to the movement component if there is none yet
+	void StartSimulation();
+
+	UFUNCTION()
+	void OnRep_LaunchData();
+
+	// Server only, called when the fuse runs out
+	void Detonate();
+
+	UFUNCTION(NetMulticast, Reliable)
+	void MulticastDetonate(const FVector_NetQuantize& Location);
+
+	// Explosion FX, called on every machine at the server detonation location
+	UFUNCTION(BlueprintImplementableEvent, Category = "Throwable Item")
+	void OnDetonated(const FVector& Location);
+
 protected:
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Throwable Item")
 	UStaticMeshComponent* ThrowableMesh = nullptr;
 
+	// Only holds the flight settings (speed, bounciness, gravity scale), the flight itself is simulated by the game state
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Throwable Item")
 	UProjectileMovementComponent* ThrowableMovement = nullptr;
 
-};
\ No newline at end of file
+	// Seconds from the throw until detonation
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Throwable Item", meta = (ClampMin = 0))
+	float FuseTime;
+
+	// Sphere swept along the flight path
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Throwable Item", meta = (ClampMin = 0))
+	float CollisionRadius;
+
+	// Damage dealt around the detonation, set BaseDamage to 0 for smoke and the like
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Throwable Item")
+	FRadialDamageParams ExplosionDamage;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Throwable Item")
+	TSubclassOf<class UDamageType> ExplosionDamageType;
+
+	UPROPERTY(ReplicatedUsing = OnRep_LaunchData)
+	FThrowableLaunchData LaunchData;
+
+	bool bDetonated;
+
+	FTimerHandle TimerHandle_Fuse;
+};
@@ -73,6 +73,27 @@ struct FWeaponAnim
 		UAnimMontage* Pawn3P;
 };
 
+/** Server acknowledgement of the fire events the owning client predicted ammo for */
+USTRUCT()
+struct FWeaponAmmoAck
+{
+	GENERATED_BODY()
+
+	FWeaponAmmoAck()
+	{
+		ShotSequence = 0;
+		AmmoInClip = 0;
+	}
+
+	/** last fire event processed by the server */
+	UPROPERTY()
+	int32 ShotSequence;
+
+	/** server clip ammo after processing ShotSequence */
+	UPROPERTY()
+	int32 AmmoInClip;
+};
+
 USTRUCT(BlueprintType)
 struct FHitScanConfiguration
 {
@@ -121,21 +142,49 @@ public:
 	AWeaponActor();
 
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual bool ReplicateSubobjects(class UActorChannel* Channel, class FOutBunch* Bunch, FReplicationFlags* RepFlags) override;
+	virtual bool CallRemoteFunction(UFunction* Function, void* Parameters, struct FOutParmRec* OutParms, FFrame* Stack) override;
 	virtual void PostInitializeComponents() override;
 	virtual void BeginPlay() override;
+	virtual void Tick(float DeltaSeconds) override;
 	virtual void Destroyed() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 protected:
 
-	/** consume a bullet */
+	/** consume a bullet, predicted on the owning client */
 	void UseClipAmmo();
 
+	/** [server] publish the current clip ammo to the owning client */
+	void UpdateAmmoAck();
+
 	/**consume ammo from the inventory */
 	void ConsumeAmmo(const int32 Amount);
 
 	/**[server] return ammo to the inventory when the weapon is unequipped*/
 	void ReturnAmmoToInventory();
 
+	/** subscribe to the owner's inventory so the ammo stack doesn't have to be searched for */
+	void BindToOwnerInventory();
+
+	/** look up the ammo stack once, called only when the owner's inventory changes */
+	void RefreshCachedAmmo();
+
+	/** sample RecoilCurve into RecoilTable, so shots never evaluate the curve */
+	void BakeRecoilTable();
+
+	/** recoil of given shot of the burst, from RecoilPattern when set, otherwise picked from RecoilTable by the seed */
+	FVector2D GetShotRecoil(const int32 ShotIndex, const int32 Seed) const;
+
+	UFUNCTION()
+	void OnOwnerInventoryItemAdded(class UItem* AddedItem);
+
+	UFUNCTION()
+	void OnOwnerInventoryItemRemoved(class UItem* RemovedItem);
+
+	UFUNCTION()
+	void OnOwnerInventoryUpdated();
+
 	/** weapon is being equipped by owner pawn */
 	virtual void OnEquip();
 
@@ -174,6 +223,10 @@ protected:
 	UFUNCTION(Reliable, client)
 	void ClientStartReload();
 
+	/** cancel a reload the server refused */
+	UFUNCTION(Reliable, client)
+	void ClientStopReload();
+
 	bool CanFire() const;
 	bool CanReload() const;
 
@@ -210,7 +263,7 @@ protected:
 
 protected:
 
-	//The weapon item in the players inventory
+	//The weapon item in the players inventory, changes when a cached weapon actor is equipped again
 	UPROPERTY(Replicated, BlueprintReadOnly, Transient)
 		class UWeaponItem* Item;
 
@@ -222,6 +275,12 @@ protected:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Config)
 	FWeaponData WeaponConfig;
 
+	/** inventory we receive add/remove notifications from */
+	TWeakObjectPtr<class UInventoryComponent> BoundInventory;
+
+	/** ammo stack in the owner's inventory. The inventory keeps a single stack per item class, so its quantity is the total ammo */
+	TWeakObjectPtr<class UItem> CachedAmmoItem;
+
 	/**Line trace data. Will be used if projectile class is null*/
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Config)
 	FHitScanConfiguration HitScanConfig;
@@ -234,11 +293,7 @@ public:
 
 protected:
 
-	/** Adjustment to handle frame rate affecting actual timer interval. */
-	UPROPERTY(Transient)
-	float TimerIntervalAdjustment;
-
-	/** Whether to allow automatic weapons to catch up with shorter refire cycles */
+	/** Whether automatic weapons fire every shot that was due since the last tick, or at most one shot per tick */
 	UPROPERTY(Config)
 	bool bAllowAutomaticWeaponCatchup = true;
 
@@ -272,6 +327,22 @@ protected:
 	UPROPERTY(Transient)
 	UParticleSystemComponent* MuzzlePSCSecondary;
 
+	/** max number of muzzle FX and one-shot sound components kept alive for reuse */
+	UPROPERTY(EditDefaultsOnly, Category = Effects, meta = (ClampMin = 1, UIMin = 1))
+	int32 EffectsPoolSize;
+
+	/** muzzle FX components that are reactivated instead of spawned on every shot */
+	UPROPERTY(Transient)
+	TArray<UParticleSystemComponent*> MuzzlePSCPool;
+
+	/** one-shot sound components that are restarted instead of spawned on every shot */
+	UPROPERTY(Transient)
+	TArray<UAudioComponent*> WeaponACPool;
+
+	/** next pooled component to recycle when every pooled component is still playing */
+	int32 NextMuzzlePSCIndex;
+	int32 NextWeaponACIndex;
+
 	/** camera shake on firing */
 	UPROPERTY(EditDefaultsOnly, Category = Effects)
 	TSubclassOf<UCameraShake> FireCameraShake;
@@ -285,6 +356,18 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = Recoil)
 	class UCurveVector* RecoilCurve;
 
+	/**Fixed spray pattern, yaw (X) and pitch (Y) of each shot in a burst. Replaces the random pick from RecoilCurve when set,
+	bursts longer than the pattern repeat its last shot*/
+	UPROPERTY(EditDefaultsOnly, Category = Recoil)
+	TArray<FVector2D> RecoilPattern;
+
+	//Number of samples RecoilCurve is baked into
+	UPROPERTY(EditDefaultsOnly, Category = Recoil, meta = (ClampMin = 2, ClampMax = 1024))
+	int32 RecoilTableSize;
+
+	//RecoilCurve sampled at evenly spaced times from 0 to 1
+	TArray<FVector2D> RecoilTable;
+
 	//The speed at which the recoil bumps up per second
 	UPROPERTY(EditDefaultsOnly, Category = Recoil)
 	float RecoilSpeed;
@@ -374,16 +457,36 @@ protected:
 	/** time of last successful weapon fire */
 	float LastFireTime;
 
+	/** time the next automatic shot is due, processed in Tick while refiring */
+	float NextShotTime;
+
+	/** shots fired and time of the first shot in the current burst, used for fire rate logging */
+	int32 BurstShotCount;
+	float BurstStartTime;
+
+	/** seed of the current burst, every shot's recoil is picked from it and the shot index */
+	int32 RecoilBurstSeed;
+
 	/** last time when this weapon was switched to */
 	float EquipStartedTime;
 
 	/** how much time weapon needs to be equipped */
 	float EquipDuration;
 
-	/** current ammo - inside clip */
-	UPROPERTY(Transient, Replicated)
+	/** current ammo - inside clip, predicted on the owning client */
+	UPROPERTY(Transient)
 	int32 CurrentAmmoInClip;
 
+	/** server clip ammo and the last fire event it includes, owning client rebuilds its prediction from it */
+	UPROPERTY(Transient, ReplicatedUsing = OnRep_AmmoAck)
+	FWeaponAmmoAck AmmoAck;
+
+	/** [local] sequence number of the last fire event sent to the server */
+	int32 LocalShotSequence;
+
+	/** [local] fire events that used predicted ammo and were not acknowledged yet */
+	TArray<int32> PendingShotSequences;
+
 	/** burst counter, used for replicating fire events to remote clients */
 	UPROPERTY(Transient, ReplicatedUsing = OnRep_BurstCounter)
 	int32 BurstCounter;
@@ -397,9 +500,6 @@ protected:
 	/** Handle for efficient management of ReloadWeapon timer */
 	FTimerHandle TimerHandle_ReloadWeapon;
 
-	/** Handle for efficient management of HandleFiring timer */
-	FTimerHandle TimerHandle_HandleFiring;
-
 	//////////////////////////////////////////////////////////////////////////
 // Input - server side
 
@@ -426,6 +526,9 @@ protected:
 	UFUNCTION()
 	void OnRep_Reload();
 
+	UFUNCTION()
+	void OnRep_AmmoAck();
+
 	/** Called in network play to do the cosmetic fx for firing */
 	virtual void SimulateWeaponFire();
 
@@ -442,18 +545,19 @@ protected:
 	UFUNCTION(Server, Reliable, WithValidation)
 	void ServerHandleHit(const FHitResult& Hit, class ASurvivalCharacter* HitPlayer = nullptr);
 
-	/** [local] weapon specific fire implementation */
-	virtual void FireShot();
+	/** [local] weapon specific fire implementation, ShotTime is when the shot was due */
+	virtual void FireShot(float ShotTime);
 
-	/** [server] fire & update ammo */
+	/** [server] fire & update ammo, ShotSequence is acknowledged back through AmmoAck.
+	 * ShotAge is how long before the client's tick the shot was due, catch-up shots keep their spacing on the server */
 	UFUNCTION(Reliable, Server, WithValidation)
-	void ServerHandleFiring();
+	void ServerHandleFiring(int32 ShotSequence, float ShotAge);
 
-	/** [local + server] handle weapon refire, compensating for slack time if the timer can't sample fast enough */
+	/** [local] fire every shot that became due since the last tick, each with its own timestamp */
 	void HandleReFiring();
 
-	/** [local + server] handle weapon fire */
-	void HandleFiring();
+	/** [local + server] handle weapon fire, ShotTime is when the shot was due */
+	void HandleFiring(float ShotTime);
 
 	/** [local + server] firing started */
 	virtual void OnBurstStarted();
@@ -470,7 +574,7 @@ protected:
 	/** attaches weapon mesh to pawn's mesh */
 	void AttachMeshToPawn();
 
-	/** detaches weapon mesh from pawn */
+	/** detaches weapon mesh from pawn, hides it and stops it from ticking */
 	void DetachMeshFromPawn();
 
 
@@ -480,6 +584,15 @@ protected:
 	/** play weapon sounds */
 	UAudioComponent* PlayWeaponSound(USoundCue* Sound);
 
+	/** play one-shot weapon sounds using the pooled audio components */
+	UAudioComponent* PlayPooledWeaponSound(USoundCue* Sound);
+
+	/** reactivate a pooled muzzle FX component, creating one if the pool isn't full yet */
+	UParticleSystemComponent* ActivatePooledMuzzleFX();
+
+	/** destroy all pooled effect components */
+	void ReleaseEffectPools();
+
 	/** play weapon animations */
 	float PlayWeaponAnimation(const FWeaponAnim& Animation);
 
@@ -37,6 +37,7 @@ public:
 
 protected:
 
+	virtual void PostInitializeComponents() override;
 	virtual void BeginPlay() override;
 
 	UFUNCTION()
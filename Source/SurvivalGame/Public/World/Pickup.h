@@ -26,6 +26,7 @@ public:
 
 protected:
 
+	virtual void PostInitializeComponents() override;
 	virtual void BeginPlay() override;
 
 	UFUNCTION()
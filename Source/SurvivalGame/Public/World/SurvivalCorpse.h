@@ -0,0 +1,118 @@
+// All rights reserved Dominik Pavlicek
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "SurvivalCorpse.generated.h"
+
+class ASurvivalCharacter;
+class USkeletalMesh;
+class USkeletalMeshComponent;
+
+/** Frozen ragdoll pose, local bone rotations in the bone order of the pose mesh */
+USTRUCT()
+struct FCorpsePose
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FQuat> BoneRotations;
+
+	// Translation of the root bone, every other bone keeps its reference pose translation
+	UPROPERTY()
+	FVector RootTranslation = FVector::ZeroVector;
+
+	// Writes each rotation as three compressed shorts
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FCorpsePose> : public TStructOpsTypeTraitsBase2<FCorpsePose>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+/**
+ * What is left of a dead character: its inventory, a frozen pose and the death camera.
+ * Replaces the full character once the ragdoll settled, so capsule, movement, gear meshes and weapon go away.
+ */
+UCLASS()
+class SURVIVALGAME_API ASurvivalCorpse : public AActor
+{
+	GENERATED_BODY()
+	
+public:	
+
+	ASurvivalCorpse();
+
+	// Takes over the inventory, meshes and current pose of a dead character. Server only, call before the corpse finished spawning.
+	void InitFromCharacter(ASurvivalCharacter* Character);
+
+	UFUNCTION(BlueprintCallable, Category = "Loot")
+	FORCEINLINE class UInteractionComponent* GetInteractionComponent() const { return InteractionComp; };
+
+	UFUNCTION(BlueprintCallable, Category = "Loot")
+	FORCEINLINE class UInventoryComponent* GetInventoryComponent() const { return InventoryComp; };
+
+	virtual void CalcCamera(float DeltaTime, struct FMinimalViewInfo& OutResult) override;
+
+protected:
+
+	virtual void PostInitializeComponents() override;
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	UFUNCTION()
+	void OnInteract(class ASurvivalCharacter* Character);
+
+	// Sets the mesh and pose, merging the body part meshes into one where possible
+	UFUNCTION()
+	void OnRep_Appearance();
+
+	static void CapturePose(const USkeletalMeshComponent* Mesh, FCorpsePose& OutPose);
+
+	void ApplyPose(const FCorpsePose& InPose);
+
+protected:
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	class UBoxComponent* LootCollision = nullptr;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	class UPoseableMeshComponent* CorpseMesh = nullptr;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	class UInteractionComponent* InteractionComp = nullptr;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	class UInventoryComponent* InventoryComp = nullptr;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Death Camera")
+	float DeathCameraDistance;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Death Camera")
+	float DeathCameraHeight;
+
+	// Mesh whose skeleton the pose was captured from
+	UPROPERTY(ReplicatedUsing = OnRep_Appearance)
+	USkeletalMesh* PoseMesh = nullptr;
+
+	// Body part meshes worn at death
+	UPROPERTY(ReplicatedUsing = OnRep_Appearance)
+	TArray<USkeletalMesh*> PartMeshes;
+
+	UPROPERTY(ReplicatedUsing = OnRep_Appearance)
+	FCorpsePose Pose;
+
+	// Clients that still have the dead character take its local ragdoll pose, so the body does not jump
+	UPROPERTY(Replicated)
+	ASurvivalCharacter* SourceCharacter = nullptr;
+
+	UPROPERTY(Replicated)
+	FString PlayerName;
+};
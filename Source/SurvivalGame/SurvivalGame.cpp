@@ -1,6 +1,59 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "SurvivalGame.h"
+#include "Misc/CoreDelegates.h"
 #include "Modules/ModuleManager.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, SurvivalGame, "SurvivalGame" );
+#if STATS && !UE_BUILD_SHIPPING
+
+// Same count the soak and survival.BenchInventory read, all threads
+DECLARE_DWORD_COUNTER_STAT(TEXT("Allocations"), STAT_Allocations, STATGROUP_SurvivalGame);
+
+#endif
+
+class FSurvivalGameModule : public FDefaultGameModuleImpl
+{
+public:
+
+	virtual void StartupModule() override {
+
+#if STATS && !UE_BUILD_SHIPPING
+		LastAllocationCount = GetAllocationCount();
+		EndFrameHandle = FCoreDelegates::OnEndFrame.AddRaw(this, &FSurvivalGameModule::UpdateAllocationStat);
+#endif
+	}
+
+	virtual void ShutdownModule() override {
+
+#if STATS && !UE_BUILD_SHIPPING
+		FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+#endif
+	}
+
+#if STATS && !UE_BUILD_SHIPPING
+private:
+
+	static uint64 GetAllocationCount() {
+
+		return FMalloc::TotalMallocCalls + FMalloc::TotalReallocCalls;
+	}
+
+	void UpdateAllocationStat() {
+
+		const uint64 AllocationCount = GetAllocationCount();
+		INC_DWORD_STAT_BY(STAT_Allocations, AllocationCount - LastAllocationCount);
+		LastAllocationCount = AllocationCount;
+	}
+
+	FDelegateHandle EndFrameHandle;
+
+	uint64 LastAllocationCount = 0;
+#endif
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FSurvivalGameModule, SurvivalGame, "SurvivalGame" );
+
+DEFINE_LOG_CATEGORY(LogSurvivalCombat);
+DEFINE_LOG_CATEGORY(LogSurvivalInventory);
+
+DEFINE_STAT(STAT_GameplayObjectsCreated);
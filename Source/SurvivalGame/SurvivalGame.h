@@ -3,5 +3,19 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
 
-#define COLLISION_WEAPON ECC_GameTraceChannel1
\ No newline at end of file
+#define COLLISION_WEAPON ECC_GameTraceChannel1
+
+DECLARE_STATS_GROUP(TEXT("SurvivalGame"), STATGROUP_SurvivalGame, STATCAT_Advanced);
+
+// Times a gameplay hot path for stat SurvivalGame and shows it as a CPU scope in Insights captures (-trace=cpu)
+#define SURVIVAL_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE(Stat)
+
+// Counters shared by the whole module, cycle stats are declared in the file that uses them
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Gameplay Objects Created"), STAT_GameplayObjectsCreated, STATGROUP_SurvivalGame, SURVIVALGAME_API);
+
+DECLARE_LOG_CATEGORY_EXTERN(LogSurvivalCombat, Log, All);
+DECLARE_LOG_CATEGORY_EXTERN(LogSurvivalInventory, Log, All);